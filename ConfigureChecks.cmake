@@ -34,4 +34,27 @@ if( WITH_XCOMPOSITE )
   else()
     tde_message_fatal( "xcomposite support was requested, but xcomposite was not found on your system" )
   endif()
-endif( WITH_XCOMPOSITE )
\ No newline at end of file
+endif( WITH_XCOMPOSITE )
+
+# XCB (pipelined window property reads in libleafbar)
+pkg_search_module( XCB xcb )
+if( NOT XCB_FOUND )
+  tde_message_fatal( "xcb is required, but was not found on your system" )
+endif()
+
+pkg_search_module( X11_XCB x11-xcb )
+if( NOT X11_XCB_FOUND )
+  tde_message_fatal( "x11-xcb is required, but was not found on your system" )
+endif()
+
+if( BUILD_BENCHMARKS )
+  pkg_search_module( X11 x11 )
+  if( NOT X11_FOUND )
+    tde_message_fatal( "benchmarks were requested, but x11 was not found on your system" )
+  endif()
+
+  find_program( XVFB_EXECUTABLE Xvfb )
+  if( NOT XVFB_EXECUTABLE )
+    message( STATUS "Xvfb was not found, the window storm benchmark cannot be run" )
+  endif()
+endif( BUILD_BENCHMARKS )
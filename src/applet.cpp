@@ -45,6 +45,12 @@ void LeafbarApplet::resizeEvent(TQResizeEvent *e) {
     emit updateGeometry();
 }
 
+/* Called before stats() is reported, for applets to refresh counters that
+   are not updated as they go (such as cache sizes) */
+void LeafbarApplet::updateStats()
+{
+}
+
 /// slot
 void LeafbarApplet::reconfigure()
 {
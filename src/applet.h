@@ -27,6 +27,10 @@
 
 // Leafbar
 #include "applet_panel_extension.h"
+#include "applet_stats.h"
+#include "deferred_calls.h"
+#include "window_events.h"
+#include "window_model.h"
 
 class LeafbarPanel;
 
@@ -41,6 +45,8 @@ class LeafbarApplet : public TQFrame {
     virtual TQString lastErrorMessage();
 
     TDEConfig *config() { return m_cfg; }
+    LeafbarAppletStats *stats() { return &m_stats; }
+    virtual void updateStats();
 
   signals:
     void updateGeometry();
@@ -53,6 +59,7 @@ class LeafbarApplet : public TQFrame {
 
   private:
     TDEConfig *m_cfg;
+    LeafbarAppletStats m_stats;
 };
 
 #endif // _LEAFBAR_APPLET_H
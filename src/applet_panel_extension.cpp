@@ -20,6 +20,7 @@
 #include <kdebug.h>
 
 // Leafbar
+#include "window_model.h"
 #include "applet_panel_extension.h"
 #include "applet_panel_extension.moc"
 
@@ -32,7 +33,8 @@ LeafbarAppletPanelExtension *LeafbarAppletPanelExtension::instance() {
 }
 
 LeafbarAppletPanelExtension::LeafbarAppletPanelExtension()
-: TQObject()
+: TQObject(),
+  m_windowModel(nullptr)
 {}
 
 LeafbarAppletPanelExtension::~LeafbarAppletPanelExtension() {}
@@ -48,4 +50,13 @@ void LeafbarAppletPanelExtension::launch(KService::Ptr service, KURL::List urls)
     emit launchRequest(service, urls);
 }
 
+LeafbarWindowModel *LeafbarAppletPanelExtension::windowModel()
+{
+    if (!m_windowModel)
+    {
+        m_windowModel = new LeafbarWindowModel(this);
+    }
+    return m_windowModel;
+}
+
 /* kate: replace-tabs true; tab-width 4; */
\ No newline at end of file
@@ -28,6 +28,8 @@
 
 #define panelExt LeafbarAppletPanelExtension::instance()
 
+class LeafbarWindowModel;
+
 class LeafbarAppletPanelExtension : public TQObject {
   TQ_OBJECT
 
@@ -37,6 +39,8 @@ class LeafbarAppletPanelExtension : public TQObject {
     void popup(TQString icon, TQString caption, TQString message);
     void launch(KService::Ptr service, KURL::List urls = KURL::List());
 
+    LeafbarWindowModel *windowModel();
+
   signals:
     void popupRequest(TQString icon, TQString caption, TQString message);
     void launchRequest(KService::Ptr service, KURL::List urls = KURL::List());
@@ -44,6 +48,8 @@ class LeafbarAppletPanelExtension : public TQObject {
   private:
     LeafbarAppletPanelExtension();
     ~LeafbarAppletPanelExtension();
+
+    LeafbarWindowModel *m_windowModel;
 };
 
 #endif // _LEAFBAR_H
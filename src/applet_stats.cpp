@@ -0,0 +1,181 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+// TQt
+#include <tqfile.h>
+#include <tqmap.h>
+#include <tqtextstream.h>
+#include <tqtl.h>
+
+// Leafbar
+#include "applet_stats.h"
+
+// stdlib
+#include <time.h>
+
+// Number of recent samples percentiles are computed from
+#define STATS_SAMPLES 1024
+
+/* Names of the keys handed out so far, shared by all applets. Built on first
+   use, as keys are usually registered during static initialisation. */
+static TQValueVector<TQString> &keyNames()
+{
+    static TQValueVector<TQString> names;
+    return names;
+}
+
+static TQMap<TQString, uint> &keyIndex()
+{
+    static TQMap<TQString, uint> index;
+    return index;
+}
+
+LeafbarAppletStats::LeafbarAppletStats()
+{
+}
+
+LeafbarAppletStats::~LeafbarAppletStats()
+{
+}
+
+uint LeafbarAppletStats::key(const TQString &name)
+{
+    TQMap<TQString, uint>::ConstIterator it = keyIndex().find(name);
+    if (it != keyIndex().end()) return it.data();
+
+    uint k = keyNames().count();
+    keyNames().append(name);
+    keyIndex().insert(name, k);
+    return k;
+}
+
+void LeafbarAppletStats::count(uint counter, ulong n)
+{
+    if (counter >= m_counters.count()) m_counters.resize(keyNames().count());
+
+    Counter &c = m_counters[counter];
+    c.used = true;
+    c.value += n;
+}
+
+void LeafbarAppletStats::set(uint counter, ulong value)
+{
+    if (counter >= m_counters.count()) m_counters.resize(keyNames().count());
+
+    Counter &c = m_counters[counter];
+    c.used = true;
+    c.value = value;
+}
+
+ulong LeafbarAppletStats::counter(uint counter) const
+{
+    return counter < m_counters.count() ? m_counters[counter].value : 0;
+}
+
+void LeafbarAppletStats::sample(uint timer, ulong usec)
+{
+    if (timer >= m_timers.count()) m_timers.resize(keyNames().count());
+
+    Samples &s = m_timers[timer];
+    if (s.recent.count() < STATS_SAMPLES)
+    {
+        s.recent.append(usec);
+    }
+    else
+    {
+        s.recent[s.next] = usec;
+        s.next = (s.next + 1) % STATS_SAMPLES;
+    }
+
+    ++s.count;
+    s.total += usec;
+    if (usec > s.max) s.max = usec;
+}
+
+/* One line per counter and timer. Timer percentiles are computed over the
+   most recent samples only; times are in microseconds. */
+TQStringList LeafbarAppletStats::report() const
+{
+    TQStringList counters, timers;
+
+    for (uint k = 0; k < m_counters.count(); ++k)
+    {
+        if (!m_counters[k].used) continue;
+        counters << TQString("%1=%2").arg(keyNames()[k]).arg(m_counters[k].value);
+    }
+
+    for (uint k = 0; k < m_timers.count(); ++k)
+    {
+        const Samples &s = m_timers[k];
+        if (s.count == 0) continue;
+
+        TQValueVector<ulong> sorted(s.recent);
+        tqHeapSort(sorted);
+
+        ulong p50 = sorted[(sorted.count() - 1) / 2];
+        ulong p99 = sorted[(sorted.count() - 1) * 99 / 100];
+
+        timers << TQString("%1: count=%2 total=%3 p50=%4 p99=%5 max=%6")
+                  .arg(keyNames()[k]).arg(s.count).arg(s.total)
+                  .arg(p50).arg(p99).arg(s.max);
+    }
+
+    counters.sort();
+    timers.sort();
+    return counters + timers;
+}
+
+/* Monotonic clock, in microseconds */
+ulong LeafbarAppletStats::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+}
+
+/* Peak resident set size of the panel process, in kB */
+ulong LeafbarAppletStats::peakMemory()
+{
+    TQFile status("/proc/self/status");
+    if (!status.open(IO_ReadOnly)) return 0;
+
+    TQTextStream stream(&status);
+    while (!stream.atEnd())
+    {
+        TQString line = stream.readLine();
+        if (line.startsWith("VmHWM:"))
+        {
+            return line.mid(6).stripWhiteSpace().section(' ', 0, 0).toULong();
+        }
+    }
+    return 0;
+}
+
+LeafbarStatsTimer::LeafbarStatsTimer(LeafbarAppletStats *stats, uint timer)
+  : m_stats(stats),
+    m_timer(timer),
+    m_start(LeafbarAppletStats::now())
+{
+}
+
+LeafbarStatsTimer::~LeafbarStatsTimer()
+{
+    m_stats->sample(m_timer, LeafbarAppletStats::now() - m_start);
+}
+
+/* kate: replace-tabs true; tab-width 4; */
@@ -0,0 +1,95 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+#ifndef _LEAFBAR_APPLET_STATS_H
+#define _LEAFBAR_APPLET_STATS_H
+
+// TQt
+#include <tqstringlist.h>
+#include <tqvaluevector.h>
+
+/* Runtime counters and latency samples kept by each applet, so that the cost
+   of its event handling can be measured on a live session.
+
+   Counter and timer names are registered once per process with key(), and
+   the integer keys are used from then on, so that hot paths do not build a
+   string and look it up on every update:
+
+     static const uint statRepaints = LeafbarAppletStats::key("repaints");
+     ...
+     stats()->count(statRepaints); */
+class LeafbarAppletStats
+{
+  public:
+    LeafbarAppletStats();
+    ~LeafbarAppletStats();
+
+    static uint key(const TQString &name);
+
+    void count(uint counter, ulong n = 1);
+    void set(uint counter, ulong value);
+    void sample(uint timer, ulong usec);
+    ulong counter(uint counter) const;
+
+    // For names only known at run time
+    void count(const TQString &counter, ulong n = 1) { count(key(counter), n); }
+    void set(const TQString &counter, ulong value) { set(key(counter), value); }
+    void sample(const TQString &timer, ulong usec) { sample(key(timer), usec); }
+
+    TQStringList report() const;
+
+    static ulong now();
+    static ulong peakMemory();
+
+  private:
+    struct Counter
+    {
+      Counter() : used(false), value(0) {}
+      bool used;
+      ulong value;
+    };
+
+    struct Samples
+    {
+      Samples() : next(0), count(0), total(0), max(0) {}
+      TQValueVector<ulong> recent;
+      uint next;
+      ulong count, total, max;
+    };
+
+    // Both indexed by key, grown as keys are registered
+    TQValueVector<Counter> m_counters;
+    TQValueVector<Samples> m_timers;
+};
+
+/* Measures its own lifetime into the given timer */
+class LeafbarStatsTimer
+{
+  public:
+    LeafbarStatsTimer(LeafbarAppletStats *stats, uint timer);
+    ~LeafbarStatsTimer();
+
+  private:
+    LeafbarAppletStats *m_stats;
+    uint m_timer;
+    ulong m_start;
+};
+
+#endif // _LEAFBAR_APPLET_STATS_H
+
+/* kate: replace-tabs true; tab-width 2; */
@@ -71,7 +71,7 @@ extern "C"
 
 LeafbarPager::LeafbarPager(LeafbarPanel *parent, TDEConfig *cfg)
   : LeafbarApplet(parent, cfg, "LeafbarPager"),
-    m_twin(new KWinModule(this)),
+    m_twin(panelExt->windowModel()->twin()),
     m_valid(false),
     m_layout(nullptr),
     m_useViewports(false),
@@ -96,12 +96,13 @@ LeafbarPager::LeafbarPager(LeafbarPanel *parent, TDEConfig *cfg)
     connect(m_twin, TQ_SIGNAL(desktopNamesChanged()),
                     TQ_SLOT(desktopNamesChanged()));
 
-    connect(m_twin, TQ_SIGNAL(windowAdded(WId)),
-                    TQ_SLOT(windowChanged(WId)));
-    connect(m_twin, TQ_SIGNAL(windowRemoved(WId)),
-                    TQ_SLOT(windowChanged(WId)));
-    connect(m_twin, TQ_SIGNAL(windowChanged(WId)),
-                    TQ_SLOT(windowChanged(WId)));
+    LeafbarWindowModel *model = panelExt->windowModel();
+    connect(model, TQ_SIGNAL(windowAdded(WId)),
+                   TQ_SLOT(windowChanged(WId)));
+    connect(model, TQ_SIGNAL(windowRemoved(WId)),
+                   TQ_SLOT(windowChanged(WId)));
+    connect(model, TQ_SIGNAL(windowChanged(WId, unsigned int, unsigned int)),
+                   TQ_SLOT(windowChanged(WId, unsigned int)));
 
     connect(tdeApp, TQ_SIGNAL(backgroundChanged(int)),
                     TQ_SLOT(desktopUpdated(int)));
@@ -112,7 +113,6 @@ LeafbarPager::LeafbarPager(LeafbarPanel *parent, TDEConfig *cfg)
 
 LeafbarPager::~LeafbarPager()
 {
-    ZAP(m_twin);
     m_desktops.clear();
 }
 
@@ -254,6 +254,14 @@ void LeafbarPager::windowChanged(WId window)
 {
 }
 
+void LeafbarPager::windowChanged(WId window, unsigned int properties)
+{
+    if (properties & (NET::WMGeometry | NET::WMDesktop | NET::WMState | NET::XAWMState))
+    {
+        windowChanged(window);
+    }
+}
+
 void LeafbarPager::desktopUpdated(int desktop)
 {
 }
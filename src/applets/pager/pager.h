@@ -67,6 +67,7 @@ class LeafbarPager : public LeafbarApplet
     void desktopGeometryChanged(int desktop);
     void desktopNamesChanged();
     void windowChanged(WId window);
+    void windowChanged(WId window, unsigned int properties);
     void desktopUpdated(int desktop);
     void updateCurrentDesktop();
 
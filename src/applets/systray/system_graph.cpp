@@ -56,7 +56,8 @@ LeafbarSystemGraph::LeafbarSystemGraph(LeafbarStatusWidget *status, const char *
     m_pollingFrequency(1500),
     m_maxValue(0),
     m_value(0),
-    m_aggregateMaxValues(aggregateMaxValues)
+    m_aggregateMaxValues(aggregateMaxValues),
+    m_requestTime(0)
 {
     m_endpoints = TQStringList(endpoints);
 
@@ -161,7 +162,7 @@ void LeafbarSystemGraph::update() {
                                  .arg(name())
                                  .arg(perc));
         }
-        TQTimer::singleShot(0, this, TQ_SLOT(repaint()));
+        deferredCalls->call(this, TQ_SLOT(repaint()));
 
         reset();
         int pollingTimeout = m_pollingFrequency;
@@ -184,8 +185,13 @@ void LeafbarSystemGraph::update() {
     m_isReceiving = true;
 }
 
+LeafbarAppletStats *LeafbarSystemGraph::stats() {
+    return statusWidget()->sysTray()->stats();
+}
+
 bool LeafbarSystemGraph::write(TQString msg) {
     if (!m_ksgrd) return false;
+    m_requestTime = LeafbarAppletStats::now();
     TQCString data = msg.latin1();
     return m_ksgrd->writeStdin(data, data.length());
 }
@@ -210,6 +216,12 @@ void LeafbarSystemGraph::slotDaemonStdout(TDEProcess *, char *buffer, int buflen
     if (m_isOnline && !m_isReceiving) return;
     m_isReceiving = false;
 
+    if (m_requestTime) {
+        stats()->sample(TQString("sensorPoll.%1").arg(name()),
+                        LeafbarAppletStats::now() - m_requestTime);
+        m_requestTime = 0;
+    }
+
     CHECK_EMPTY_RESPONSE
     resetRetryCount();
 
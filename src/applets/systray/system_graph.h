@@ -44,6 +44,8 @@ class LeafbarSystemGraph : public TQWidget {
         return static_cast<LeafbarStatusWidget *>(parent());
     }
 
+    LeafbarAppletStats *stats();
+
     KService::Ptr systemMonitor();
     KService::Ptr processManager();
     KService::Ptr terminalEmulator();
@@ -87,6 +89,7 @@ class LeafbarSystemGraph : public TQWidget {
     bool m_aggregateMaxValues;
 
     KService::List m_tools;
+    ulong m_requestTime;
 
     bool write(TQString msg);
 
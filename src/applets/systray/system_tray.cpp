@@ -95,7 +95,7 @@ LeafbarSysTray::LeafbarSysTray(LeafbarPanel *parent, TDEConfig *cfg)
     setMidLineWidth(3);
     setMargin(5);
 
-    m_twin = new KWinModule(this);
+    m_twin = panelExt->windowModel()->twin();
 
     const WIdList systrayWindows = m_twin->systemTrayWindows();
     for (WIdList::ConstIterator it = systrayWindows.begin();
@@ -0,0 +1,140 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+/* Times LeafbarTaskButton::elide() over generated long window titles, next to
+   the per-character truncation it replaced. Needs an X display for the font
+   metrics. Usage: leafbar_elide_benchmark [titles] [rounds] */
+
+// TQt
+#include <tqapplication.h>
+#include <tqfontmetrics.h>
+#include <tqstringlist.h>
+
+// Leafbar
+#include "task_button.h"
+
+// stdlib
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+
+static const char *words[] = {
+    "Mozilla", "Firefox", "Konsole", "bash", "src", "leafbar", "applets",
+    "taskman", "task_manager.cpp", "Inbox", "(42", "unread)", "—", "Kate",
+    "Document", "Report", "final", "v2", "édition", "Übersicht", "~/projects",
+    "git", "log", "--oneline", "Trinity", "Desktop", "Environment", "–"
+};
+static const int wordCount = sizeof(words) / sizeof(words[0]);
+
+static ulong now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+}
+
+/* The truncation elide() replaced: one width measurement per prefix */
+static TQString elideLinear(const TQFontMetrics &fm, const TQString &text, int width)
+{
+    if (fm.width(text) <= width)
+    {
+        return text;
+    }
+
+    TQString ellipsis = TQString::fromUtf8("…");
+    int space = width - fm.width(ellipsis);
+
+    int ci = 0;
+    while (ci < (int)text.length() && fm.width(text, ci + 1) <= space) ++ci;
+    return text.left(ci) + ellipsis;
+}
+
+/* Titles of 60 to 300 characters, made of words picked at random */
+static TQStringList generateTitles(int count)
+{
+    TQStringList titles;
+    srand(1);
+    for (int i = 0; i < count; ++i)
+    {
+        int length = 60 + rand() % 241;
+        TQString title;
+        while ((int)title.length() < length)
+        {
+            if (!title.isEmpty()) title += ' ';
+            title += TQString::fromUtf8(words[rand() % wordCount]);
+        }
+        titles << title.left(length);
+    }
+    return titles;
+}
+
+typedef TQString (*ElideFunction)(const TQFontMetrics &, const TQString &, int);
+
+/* Returns the average time in microseconds to elide one title */
+static double run(ElideFunction elide, const TQFontMetrics &fm,
+                  const TQStringList &titles, int width, int rounds)
+{
+    ulong length = 0;
+    ulong start = now();
+    for (int r = 0; r < rounds; ++r)
+    {
+        TQStringList::ConstIterator it;
+        for (it = titles.begin(); it != titles.end(); ++it)
+        {
+            length += elide(fm, *it, width).length();
+        }
+    }
+    ulong elapsed = now() - start;
+
+    // Keeps the results alive
+    if (length == 0) printf("no output\n");
+    return (double)elapsed / (rounds * titles.count());
+}
+
+int main(int argc, char **argv)
+{
+    TQApplication app(argc, argv);
+
+    int count = (argc > 1) ? atoi(argv[1]) : 1000;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 10;
+    if (count <= 0 || rounds <= 0)
+    {
+        fprintf(stderr, "usage: %s [titles] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    TQStringList titles = generateTitles(count);
+    TQFont font = app.font();
+    TQFontMetrics fm(font);
+
+    printf("%d titles, %d rounds, font %s %dpt\n", count, rounds,
+           font.family().local8Bit().data(), font.pointSize());
+    printf("%8s %14s %14s\n", "width", "bisection µs", "linear µs");
+
+    const int widths[] = { 80, 160, 320, 640 };
+    for (uint i = 0; i < sizeof(widths) / sizeof(widths[0]); ++i)
+    {
+        double bisection = run(LeafbarTaskButton::elide, fm, titles, widths[i], rounds);
+        double linear = run(elideLinear, fm, titles, widths[i], rounds);
+        printf("%8d %14.2f %14.2f\n", widths[i], bisection, linear);
+    }
+
+    return 0;
+}
+
+/* kate: replace-tabs true; tab-width 4; */
@@ -22,6 +22,7 @@
 
 // TQt
 #include <tqtimer.h>
+#include <tqevent.h>
 #include <tqpainter.h>
 #include <tqpalette.h>
 #include <tqfileinfo.h>
@@ -48,27 +49,102 @@
 // stdlib
 #include <cerrno>
 
-LeafbarTask::LeafbarTask(LeafbarTaskContainer *parent, WId w)
-  : LeafbarTaskButton(parent, LeafbarTaskButton::Task),
+static const uint statTaskWidgetsCreated = LeafbarAppletStats::key("taskWidgetsCreated");
+
+LeafbarTask::LeafbarTask(LeafbarTaskContainer *parent, WId w,
+                         const LeafbarWindowInfo *info)
+  : LeafbarTaskItem(parent),
     m_container(parent),
-    m_window_id(w)
-{
-    setOn(info().isMinimized());
-    parent->update();
+    m_window_id(w),
+    m_shown(false),
+    m_on(false),
+    m_valid(false),
+    m_state(0),
+    m_iconified(false),
+    m_desktop(-1),
+    m_iconRevision(0),
+    m_titleTime(0),
+    m_hasThemeIcon(false)
+{
+    parent->insertTask(this);
+    applyInfo(info, TASK_INFO_PROPERTIES);
     updateVisibility();
 }
 
 LeafbarTask::~LeafbarTask()
 {
-    TQTimer::singleShot(0, container(), TQ_SLOT(update()));
+    if (!m_container) return;
+
+    m_container->removeTask(this);
+    deferredCalls->call(m_container, TQ_SLOT(update()));
+}
+
+/* Refresh the property snapshot for the properties in the given NET::Property
+   mask (as passed to LeafbarWindowModel::windowChanged); anything else is left
+   alone. The properties themselves are read by the shared window model. */
+void LeafbarTask::updateInfo(unsigned long properties)
+{
+    unsigned long fetch = 0;
+
+    if (properties & NET::WMIcon)
+    {
+        iconChanged();
+    }
+
+    // The visible name reflects the iconified and shaded states
+    if (properties & (NET::WMState | NET::XAWMState | TASK_TITLE_PROPERTIES))
+    {
+        fetch |= NET::WMState | NET::XAWMState | TASK_TITLE_PROPERTIES;
+    }
+
+    if (properties & NET::WMDesktop)
+    {
+        fetch |= NET::WMDesktop;
+    }
+
+    if (!fetch) return;
+
+    applyInfo(panelExt->windowModel()->info(windowID()), fetch);
+}
+
+/* Called when the window has a new icon, or when the icon we asked the window
+   model for has been fetched: whatever we painted before is out of date. */
+void LeafbarTask::iconChanged()
+{
+    ++m_iconRevision;
+    m_themeIconClass = TQString::null;
+    if (container()->iconFollows(this))
+    {
+        container()->iconChanged();
+    }
 }
 
-KWin::WindowInfo LeafbarTask::info()
+void LeafbarTask::applyInfo(const LeafbarWindowInfo *i, unsigned long properties)
 {
-    return KWin::windowInfo(windowID());
+    m_valid = i && i->valid();
+    if (m_container) m_container->countTask(this, false);
+
+    if (properties & (NET::WMState | NET::XAWMState))
+    {
+        m_state = m_valid ? i->state() : 0;
+        m_iconified = m_valid && i->isMinimized();
+    }
+
+    if (properties & TASK_TITLE_PROPERTIES)
+    {
+        if (i) m_visibleName = i->visibleNameWithState();
+        m_titleTime = LeafbarAppletStats::now();
+    }
+
+    if (properties & NET::WMDesktop)
+    {
+        m_desktop = m_valid ? i->desktop() : -1;
+    }
+
+    if (m_container) m_container->countTask(this, true);
 }
 
-LeafbarTaskContainer* LeafbarTask::container()
+LeafbarTaskContainer* LeafbarTask::container() const
 {
     return m_container;
 }
@@ -80,7 +156,7 @@ KWinModule* LeafbarTask::twin()
 
 TQString LeafbarTask::name()
 {
-    TQString taskName = info().visibleNameWithState();
+    TQString taskName = m_visibleName;
 
     if (container()->manager()->showDesktopNumber())
     {
@@ -100,38 +176,72 @@ TQString LeafbarTask::name()
     return taskName;
 }
 
-TQPixmap LeafbarTask::icon()
+TQImage LeafbarTask::icon()
+{
+    return icon(LeafbarTaskButton::smallIconSize());
+}
+
+TQImage LeafbarTask::icon(TQSize size)
 {
-    return icon(smallIconSize());
+    TQImage ico = ownIcon(size);
+    return ico.isNull() ? container()->groupIcon() : ico;
 }
 
-TQPixmap LeafbarTask::icon(TQSize size)
+/* The window icon is fetched in the background the first time a size is
+   asked for; until then the themed icon for the class stands in for it.
+   Returns a null image if there is neither. */
+TQImage LeafbarTask::ownIcon(TQSize size)
 {
-    TQPixmap ico = KWin::icon(windowID(), size.width(), size.height(), true);
+    TQImage ico = panelExt->windowModel()->icon(windowID(), size.width(), size.height());
     if (!ico.isNull()) {
         return ico;
     }
 
-    ico = tdeApp->iconLoader()->loadIcon(className().lower(),
-                                         TDEIcon::Panel, size.height(),
-                                         TDEIcon::DefaultState,
-                                         0, true);
-    if (!ico.isNull())
+    return LeafbarTaskButton::themeIcon(className().lower(), size.height());
+}
+
+/* Whether ownIcon() has something to show, without loading the icon. Only
+   the lookup of the themed icon is remembered, the window model keeps the
+   window icons anyway. */
+bool LeafbarTask::hasOwnIcon()
+{
+    TQSize size = LeafbarTaskButton::smallIconSize();
+    if (!panelExt->windowModel()->icon(windowID(), size.width(), size.height()).isNull())
     {
-        return ico;
+        return true;
+    }
+
+    TQString cls = className().lower();
+    if (cls != m_themeIconClass)
+    {
+        m_themeIconClass = cls;
+        m_hasThemeIcon = !tdeApp->iconLoader()->iconPath(cls, -size.height(), true).isEmpty();
     }
+    return m_hasThemeIcon;
+}
 
-    return container()->groupIcon();
+/* Tasks without an icon of their own all paint the group icon, so they share
+   its key and only those change with the icon revision of the container. */
+TQString LeafbarTask::iconCacheKey()
+{
+    if (!hasOwnIcon())
+    {
+        return TQString("group-%1-%2").arg(container()->applicationClass())
+                                      .arg(container()->iconRevision());
+    }
+    return TQString("task-%1-%2").arg(windowID()).arg(m_iconRevision);
 }
 
 TQString LeafbarTask::className()
 {
-    return LeafbarTaskMan::className(windowID());
+    const LeafbarWindowInfo *i = panelExt->windowModel()->info(windowID());
+    return i ? i->resourceName() : TQString::null;
 }
 
 TQString LeafbarTask::classClass()
 {
-    return LeafbarTaskMan::classClass(windowID());
+    const LeafbarWindowInfo *i = panelExt->windowModel()->info(windowID());
+    return i ? i->resourceClass() : TQString::null;
 }
 
 TQString LeafbarTask::applicationName()
@@ -139,12 +249,45 @@ TQString LeafbarTask::applicationName()
     return container()->application();
 }
 
+void LeafbarTask::setOn(bool on)
+{
+    if (on == m_on) return;
+    m_on = on;
+    scheduleRepaint();
+}
+
+/* In the classic layout tasks of expanded groupers have a button, those of
+   collapsed groupers get theirs released by the container after a while.
+   The task view paints the tasks without any. */
 void LeafbarTask::updateVisibility()
 {
-    setShown(
-      container()->grouper()->expanded() &&
-      (container()->manager()->showAllDesktops() || isOnCurrentDesktop())
-    );
+    bool expanded = container()->grouper()->expanded();
+
+    container()->countTask(this, false);
+    m_shown = expanded &&
+              (container()->manager()->showAllDesktops() || isOnCurrentDesktop());
+    container()->countTask(this, true);
+
+    if (expanded && !button() && container()->box())
+    {
+        createButton(container()->box());
+        container()->manager()->stats()->count(statTaskWidgetsCreated);
+    }
+
+    if (button())
+    {
+        button()->setShown(m_shown);
+    }
+
+    if (container()->manager()->view())
+    {
+        deferredCalls->call(container()->manager(), TQ_SLOT(relayout()));
+    }
+}
+
+bool LeafbarTask::showIcon() const
+{
+    return container()->manager()->showTaskIcons();
 }
 
 void LeafbarTask::mousePressEvent(TQMouseEvent *me)
@@ -173,7 +316,7 @@ void LeafbarTask::mousePressEvent(TQMouseEvent *me)
 
 void LeafbarTask::contextMenuEvent(TQContextMenuEvent *cme)
 {
-    TDEPopupMenu ctx(this), desks(this);
+    TDEPopupMenu ctx, desks;
     ctx.setCheckable(true);
 
     int item;
@@ -250,6 +393,28 @@ void LeafbarTask::contextMenuEvent(TQContextMenuEvent *cme)
     ctx.exec(cme->globalPos());
 }
 
+TQFont LeafbarTask::font()
+{
+    return isActive() ? LeafbarTaskButton::boldFont() : LeafbarTaskButton::normalFont();
+}
+
+TQColorGroup LeafbarTask::colors()
+{
+    TQColorGroup cg = LeafbarTaskItem::colors();
+    if (isActive())
+    {
+        cg.setColor(TQColorGroup::Button,     cg.highlight());
+        cg.setColor(TQColorGroup::Background, cg.highlight());
+        cg.setColor(TQColorGroup::ButtonText, cg.highlightedText());
+    }
+    else if (!container()->isActive())
+    {
+        cg.setColor(TQColorGroup::Button,     cg.background());
+        cg.setColor(TQColorGroup::ButtonText, cg.foreground());
+    }
+    return cg;
+}
+
 void LeafbarTask::sendToTray()
 {
     TDEProcess ksystray;
@@ -274,8 +439,7 @@ void LeafbarTask::setDesktop(int desktop)
 
 bool LeafbarTask::checkWindowState(unsigned long state)
 {
-    KWin::WindowInfo i(info());
-    return i.valid() && (i.state() & state);
+    return m_valid && (m_state & state);
 }
 
 void LeafbarTask::addWindowState(unsigned long state)
@@ -389,8 +553,7 @@ bool LeafbarTask::staysBelow()
 
 bool LeafbarTask::isIconified()
 {
-    KWin::WindowInfo i(info());
-    return i.valid() && i.isMinimized();
+    return m_iconified;
 }
 
 bool LeafbarTask::isMaximized()
@@ -408,17 +571,14 @@ bool LeafbarTask::isShaded()
     return checkWindowState(NET::Shaded);
 }
 
-int LeafbarTask::desktop()
+bool LeafbarTask::skipsTaskbar()
 {
-    KWin::WindowInfo i(info());
-    if (!i.valid()) return -1;
-
-    if (i.onAllDesktops())
-    {
-        return 0;
-    }
+    return checkWindowState(NET::SkipTaskbar);
+}
 
-    return i.desktop();
+int LeafbarTask::desktop()
+{
+    return m_desktop;
 }
 
 bool LeafbarTask::isOnCurrentDesktop()
@@ -427,54 +587,26 @@ bool LeafbarTask::isOnCurrentDesktop()
     return deskno == 0 || deskno == twin()->currentDesktop();
 }
 
-TQFont LeafbarTask::font()
+pid_t LeafbarTask::pid()
 {
-    return isActive() ? boldFont() : normalFont();
+    const LeafbarWindowInfo *i = panelExt->windowModel()->info(windowID());
+    return i ? i->pid() : 0;
 }
 
-TQColorGroup LeafbarTask::colors()
+TQString LeafbarTask::cmdline()
 {
-    TQColorGroup cg = LeafbarTaskButton::colors();
-    if (isActive())
-    {
-        cg.setColor(TQColorGroup::Button,     cg.highlight());
-        cg.setColor(TQColorGroup::Background, cg.highlight());
-        cg.setColor(TQColorGroup::ButtonText, cg.highlightedText());
-    }
-    else if (!container()->isActive())
-    {
-        cg.setColor(TQColorGroup::Button,     cg.background());
-        cg.setColor(TQColorGroup::ButtonText, cg.foreground());
-    }
-    return cg;
+    const LeafbarWindowInfo *i = panelExt->windowModel()->info(windowID());
+    return i ? i->cmdline() : TQString::null;
 }
 
-/* Yes, I know this is deprecated and the actual application might be on another
-   host, but this is the best way I can think of to get the application's
-   executable and figure out its corresponding desktop file. */
-pid_t LeafbarTask::pid()
+TQString LeafbarTask::executablePath()
 {
-    KWin::Info i = KWin::info(windowID());
-    return i.pid;
+    const LeafbarWindowInfo *i = panelExt->windowModel()->info(windowID());
+    return i ? i->executablePath() : TQString::null;
 }
 
-TQString LeafbarTask::cmdline() {
-    TQFile file(TQString("/proc/%1/cmdline").arg(pid()));
-    if (file.exists() && file.open(IO_ReadOnly)) {
-        return TQString::fromLocal8Bit(file.readAll());
-    }
-    return TQString::null;
-}
-
-TQString LeafbarTask::executablePath() {
-    TQFileInfo info(TQString("/proc/%1/exe").arg(pid()));
-    if (info.exists() && info.isSymLink()) {
-        return info.readLink();
-    }
-    return TQString::null;
-}
-
-TQString LeafbarTask::executable() {
+TQString LeafbarTask::executable()
+{
     return TQFileInfo(executablePath()).fileName();
 }
 
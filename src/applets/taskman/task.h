@@ -25,31 +25,58 @@
 #include <twinmodule.h>
 
 // Leafbar
-#include "task_button.h"
+#include "task_item.h"
+
+// Window properties mirrored by LeafbarTask (see LeafbarTask::updateInfo())
+#define TASK_INFO_PROPERTIES (NET::WMWindowType | NET::WMState | NET::XAWMState | \
+                              NET::WMName | NET::WMVisibleName | NET::WMDesktop)
+
+// Title properties, whose updates are rate-limited (see LeafbarTaskMan::updateWindow())
+#define TASK_TITLE_PROPERTIES (NET::WMName | NET::WMVisibleName)
 
 class LeafbarTaskContainer;
+class LeafbarWindowInfo;
 
-class LeafbarTask : public LeafbarTaskButton
+/* A window in the task list. In the classic layout the button showing it
+   only exists while its grouper is expanded, or was collapsed recently (see
+   LeafbarTaskContainer::releaseWidgets()). */
+class LeafbarTask : public LeafbarTaskItem
 {
   TQ_OBJECT
 
   public:
-    LeafbarTask(LeafbarTaskContainer *parent, WId w);
+    LeafbarTask(LeafbarTaskContainer *parent, WId w, const LeafbarWindowInfo *info);
     ~LeafbarTask();
 
+    bool isShown() const { return m_shown; }
+    bool isOn() const { return m_on; }
+    void setOn(bool on);
+
     TQString name();
-    TQPixmap icon();
-    TQPixmap icon(TQSize size);
+    TQImage icon();
+    TQImage icon(TQSize size);
+    TQImage ownIcon(TQSize size);
+    bool hasOwnIcon();
+    TQString iconCacheKey();
     TQString applicationName();
     TQString className();
     TQString classClass();
 
-    LeafbarTaskContainer *container();
+    LeafbarTaskContainer *container() const;
     KWinModule *twin();
 
+    bool showIcon() const;
+    TQFont font();
+    TQColorGroup colors();
+
+    void mousePressEvent(TQMouseEvent *);
+    void contextMenuEvent(TQContextMenuEvent *);
+
     //KService::Ptr service() { return m_service; }
     WId windowID() { return m_window_id; }
-    KWin::WindowInfo info();
+    void updateInfo(unsigned long properties);
+    void iconChanged();
+    ulong titleTime() const { return m_titleTime; }
     pid_t pid();
     TQString executablePath();
     TQString executable();
@@ -62,6 +89,7 @@ class LeafbarTask : public LeafbarTaskButton
     bool isMaximized();
     bool isFullScreen();
     bool isShaded();
+    bool skipsTaskbar();
     int desktop();
     bool isOnCurrentDesktop();
 
@@ -86,15 +114,26 @@ class LeafbarTask : public LeafbarTaskButton
 
     void updateVisibility();
 
-  protected:
-    void mousePressEvent(TQMouseEvent *);
-    void contextMenuEvent(TQContextMenuEvent *);
-    TQFont font();
-    TQColorGroup colors();
-
   private:
     LeafbarTaskContainer *m_container;
     WId m_window_id;
+    bool m_shown, m_on;
+
+    // Snapshot of the window properties we display, so that painting and
+    // menus do not have to query the X server (see updateInfo())
+    bool m_valid;
+    TQString m_visibleName;
+    unsigned long m_state;
+    bool m_iconified;
+    int m_desktop;
+    uint m_iconRevision;
+    ulong m_titleTime;
+
+    // Whether the icon theme has an icon for m_themeIconClass (see hasOwnIcon())
+    TQString m_themeIconClass;
+    bool m_hasThemeIcon;
+
+    void applyInfo(const LeafbarWindowInfo *info, unsigned long properties);
 
     bool checkWindowState(unsigned long state);
     void addWindowState(unsigned long state);
@@ -104,8 +143,6 @@ class LeafbarTask : public LeafbarTaskButton
   friend class LeafbarTaskContainer;
 };
 
-typedef TQPtrList<LeafbarTask> TaskList;
-
 #endif // _LEAFBAR_TASK_H
 
 /* kate: replace-tabs true; tab-width 2; */
\ No newline at end of file
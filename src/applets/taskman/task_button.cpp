@@ -18,7 +18,6 @@
 
 // TQt
 #include <tqtooltip.h>
-#include <tqtimer.h>
 #include <tqimage.h>
 #include <tqpainter.h>
 #include <tqpalette.h>
@@ -28,60 +27,103 @@
 #include <tdeapplication.h>
 #include <tdeglobalsettings.h>
 #include <kiconloader.h>
-#include <kdebug.h>
 
 // Leafbar
 #include "task_container.h"
+#include "task_icon_atlas.h"
+#include "task_item.h"
 #include "task_button.h"
 #include "task_button.moc"
 
-LeafbarTaskButton::LeafbarTaskButton(LeafbarTaskContainer *parent, ButtonType type)
+static const uint statRepaints = LeafbarAppletStats::key("repaints");
+static const uint statIconCacheHits = LeafbarAppletStats::key("iconCacheHits");
+static const uint statIconCacheMisses = LeafbarAppletStats::key("iconCacheMisses");
+
+// Bumped whenever the icon theme changes, see invalidateIconCache()
+static uint iconCacheGeneration = 0;
+
+// The tooltip text is only looked up when it is about to be shown
+class LeafbarTaskButtonTip : public TQToolTip
+{
+  public:
+    LeafbarTaskButtonTip(LeafbarTaskButton *button)
+      : TQToolTip(button),
+        m_button(button)
+    {}
+
+  protected:
+    void maybeTip(const TQPoint &)
+    {
+        tip(m_button->rect(), m_button->item()->name());
+    }
+
+  private:
+    LeafbarTaskButton *m_button;
+};
+
+LeafbarTaskButton::LeafbarTaskButton(TQWidget *parent, LeafbarTaskItem *item)
   : TQButton(parent),
-    m_buttonType(type)
+    m_item(item)
 {
     setSizePolicy(TQSizePolicy::Ignored, TQSizePolicy::Fixed);
-    setToggleButton(true);
+    m_tip = new LeafbarTaskButtonTip(this);
     show();
-    TQTimer::singleShot(0, this, TQ_SLOT(update()));
 }
 
 LeafbarTaskButton::~LeafbarTaskButton()
-{}
-
-void LeafbarTaskButton::update()
 {
-    TQToolTip::add(this, name());
-    TQTimer::singleShot(0, this, TQ_SLOT(repaint()));
+    delete m_tip;
 }
 
-TQString LeafbarTaskButton::name()
+TQImage LeafbarTaskButton::scaledIcon(LeafbarTaskItem *item)
 {
-    return TQString::null;
+    TQImage img = item->icon();
+    if (img.isNull() || img.size() == item->iconSize()) return img;
+    return img.smoothScale(item->iconSize());
 }
 
-TQPixmap LeafbarTaskButton::icon()
+/* Paints the icon of the item scaled to its icon size at pos. The scaled icon
+   is kept in the icon atlas for as long as the item shows it, so that
+   repainting does not refetch or rescale the icon. */
+void LeafbarTaskButton::drawIcon(TQPainter *p, LeafbarTaskItem *item, const TQPoint &pos)
 {
-    return defaultIcon();
-}
+    TQString key = item->iconCacheKey();
+    item->m_paintedIconKey = key;
 
-bool LeafbarTaskButton::showFrame() const
-{
-    return buttonType() == Grouper;
-}
+    if (key.isNull())
+    {
+        p->drawImage(pos, scaledIcon(item));
+        return;
+    }
 
-bool LeafbarTaskButton::showIcon() const
-{
-    return buttonType() != Task || container()->manager()->showTaskIcons();
-}
+    TQSize size = item->iconSize();
+    key = TQString("%1-%2-%3x%4").arg(iconCacheGeneration).arg(key)
+                                 .arg(size.width()).arg(size.height());
 
-bool LeafbarTaskButton::useBigIcon() const
-{
-    return buttonType() == Grouper && container()->manager()->bigGrouperIcons();
+    LeafbarTaskIconAtlas *atlas = LeafbarTaskIconAtlas::instance();
+    if (key != item->m_atlasKey)
+    {
+        if (atlas->acquire(key))
+        {
+            item->container()->manager()->stats()->count(statIconCacheHits);
+        }
+        else
+        {
+            item->container()->manager()->stats()->count(statIconCacheMisses);
+            atlas->insert(key, scaledIcon(item));
+        }
+
+        atlas->release(item->m_atlasKey);
+        item->m_atlasKey = key;
+    }
+
+    atlas->draw(p, pos, key);
 }
 
-TQColorGroup LeafbarTaskButton::colors()
+void LeafbarTaskButton::invalidateIconCache()
 {
-    return container()->palette().active();
+    // Old icons leave the atlas as the items showing them are repainted
+    ++iconCacheGeneration;
 }
 
 TQColor LeafbarTaskButton::blendColors(const TQColor c1, const TQColor c2)
@@ -93,15 +135,32 @@ TQColor LeafbarTaskButton::blendColors(const TQColor c1, const TQColor c2)
                    (tqBlue(rgb1)  + tqBlue(rgb2))  / 2);
 }
 
-LeafbarTaskContainer *LeafbarTaskButton::container() const
+/* Icons only ever end up in the icon atlas, so themed icons are read into an
+   image straight from their file instead of going through a pixmap. Icons
+   the image loaders cannot read (SVG) still come from the icon loader. */
+TQImage LeafbarTaskButton::themeIcon(const TQString &name, int size)
 {
-    return static_cast<LeafbarTaskContainer *>(parent());
+    TDEIconLoader *il = tdeApp->iconLoader();
+    TQString path = il->iconPath(name, -size, true);
+    if (path.isEmpty()) return TQImage();
+
+    TQImage img(path);
+    if (img.isNull())
+    {
+        return il->loadIcon(name, TDEIcon::Panel, size, TDEIcon::DefaultState,
+                            nullptr, true).convertToImage();
+    }
+    if (img.width() != size || img.height() != size)
+    {
+        img = img.smoothScale(size, size);
+    }
+    return img;
 }
 
-TQPixmap LeafbarTaskButton::defaultIcon(TQSize size)
+TQImage LeafbarTaskButton::defaultIcon(TQSize size)
 {
     if (size.isNull()) size = bigIconSize();
-    return tdeApp->iconLoader()->loadIcon("xapp", TDEIcon::Panel, size.height());
+    return themeIcon("xapp", size.height());
 }
 
 TQSize LeafbarTaskButton::bigIconSize()
@@ -124,16 +183,11 @@ TQPoint LeafbarTaskButton::smallIconOffset()
     return small.topLeft();
 }
 
-TQSize LeafbarTaskButton::iconSize() const
-{
-    return (useBigIcon() ? bigIconSize() : smallIconSize());
-}
-
-TQPoint LeafbarTaskButton::iconOffset() const
+TQPoint LeafbarTaskButton::iconMargin(bool bigIcon)
 {
     TQPoint margin(2, 2);
 
-    if (!useBigIcon())
+    if (!bigIcon)
     {
         margin += TQPoint(0, smallIconOffset().y() / 2);
     }
@@ -141,9 +195,10 @@ TQPoint LeafbarTaskButton::iconOffset() const
     return margin;
 }
 
-TQFont LeafbarTaskButton::font()
+/* Height of task items, which all use small icons (see LeafbarTaskItem::height()) */
+int LeafbarTaskButton::taskHeight()
 {
-    return normalFont();
+    return smallIconSize().height() + (iconMargin(false).y() * 2);
 }
 
 TQFont LeafbarTaskButton::normalFont()
@@ -160,44 +215,40 @@ TQFont LeafbarTaskButton::boldFont()
 
 TQSize LeafbarTaskButton::sizeHint() const
 {
-    int height = iconSize().height() + (iconOffset().y() * 2);
-    return TQSize(container()->width(), height);
+    return TQSize(parentWidget()->width(), m_item->height());
 }
 
-void LeafbarTaskButton::drawButtonLabel(TQPainter *p)
+void LeafbarTaskButton::drawLabel(TQPainter *p, LeafbarTaskItem *item, const TQRect &r)
 {
     TQPoint smallOffset = smallIconOffset();
-    TQPoint origin = iconOffset();
+    TQPoint origin = item->iconOffset();
     int offset = 0;
 
     // Render icon
-    if (showIcon())
+    if (item->showIcon())
     {
-        TQImage img = icon().convertToImage();
-        TQPixmap pix = img.scale(iconSize());
-
-        if (isOn())
+        if (item->isOn())
         {
             origin += TQPoint(1, 1);
         }
 
-        if (!useBigIcon())
+        if (!item->useBigIcon())
         {
             origin += TQPoint(smallOffset.x(), 0);
         }
 
-        p->drawPixmap(origin, pix);
-        offset = pix.width() + iconOffset().x();
+        drawIcon(p, item, r.topLeft() + origin);
+        offset = item->iconSize().width() + item->iconOffset().x();
     }
 
     // Render label
-    p->setFont(font());
+    p->setFont(item->font());
 
     TQFontMetrics fm(p->fontMetrics());
     TQPoint textOffset(origin);
     textOffset += TQPoint(offset, fm.ascent());
 
-    if (useBigIcon())
+    if (item->useBigIcon())
     {
         textOffset += TQPoint(0, smallOffset.y());
     }
@@ -206,42 +257,83 @@ void LeafbarTaskButton::drawButtonLabel(TQPainter *p)
         textOffset += TQPoint(smallOffset.x(), 0);
     }
 
-    TQString label(name());
-    int spaceForLabel = width() - textOffset.x();
-    TQString ellipsis = TQString::fromUtf8("…");
-    int ellipsisWidth = fm.width(ellipsis);
-    int charLimit = 0;
-    for (int ci = 0; ci < label.length(); ++ci)
+    TQString label(item->name());
+    int spaceForLabel = r.width() - textOffset.x() - item->iconOffset().x();
+    if (label != item->m_elideText || spaceForLabel != item->m_elideWidth ||
+        p->font() != item->m_elideFont)
     {
-        if (fm.width(label, ci) > spaceForLabel - ellipsisWidth - iconOffset().x())
-        {
-            charLimit = ci - 1;
-            break;
-        }
+        item->m_elideText = label;
+        item->m_elideWidth = spaceForLabel;
+        item->m_elideFont = p->font();
+        item->m_elided = elide(fm, label, spaceForLabel);
     }
-    if (charLimit != 0)
+
+    p->setPen(item->colors().buttonText());
+    p->drawText(r.topLeft() + textOffset, item->m_elided);
+}
+
+/* Paints the item into r, which is all there is to it: the classic layout
+   and LeafbarTaskView both paint items this way. */
+void LeafbarTaskButton::draw(TQPainter *p, LeafbarTaskItem *item, const TQRect &r)
+{
+    item->container()->manager()->stats()->count(statRepaints);
+
+    TQColorGroup cg = item->colors();
+    p->setBrush(cg.button());
+    p->setPen(cg.button());
+    p->drawRect(r);
+
+    if (item->showFrame())
     {
-        label.truncate(charLimit);
-        label.append(ellipsis);
+        // No widget to ask for its state, so it is the primitive a push button
+        // would draw itself with
+        TQStyle::SFlags flags = TQStyle::Style_Enabled | TQStyle::Style_Raised;
+        if (item->isOn()) flags |= TQStyle::Style_On;
+        tdeApp->style().drawPrimitive(TQStyle::PE_ButtonCommand, p, r, cg, flags);
     }
 
-    p->setPen(colors().buttonText());
-    p->drawText(textOffset, label);
+    drawLabel(p, item, r);
+    item->drawOverlay(p, r);
 }
 
 void LeafbarTaskButton::drawButton(TQPainter *p)
 {
-    TQColor bg = colors().button();
-    p->setBrush(bg);
-    p->setPen(bg);
-    p->drawRect(rect());
+    draw(p, m_item, rect());
+}
 
-    if (showFrame())
-    {
-      style().drawControl(TQStyle::CE_PushButton, p, this, rect(), colors());
-    }
+void LeafbarTaskButton::mousePressEvent(TQMouseEvent *me)
+{
+    m_item->mousePressEvent(me);
+}
 
-    drawButtonLabel(p);
+void LeafbarTaskButton::mouseReleaseEvent(TQMouseEvent *me)
+{
+    m_item->mouseReleaseEvent(me);
+}
+
+void LeafbarTaskButton::mouseDoubleClickEvent(TQMouseEvent *me)
+{
+    m_item->mouseDoubleClickEvent(me);
+}
+
+void LeafbarTaskButton::mouseMoveEvent(TQMouseEvent *me)
+{
+    m_item->mouseMoveEvent(me);
+}
+
+void LeafbarTaskButton::enterEvent(TQEvent *e)
+{
+    m_item->enterEvent(e);
+}
+
+void LeafbarTaskButton::leaveEvent(TQEvent *e)
+{
+    m_item->leaveEvent(e);
+}
+
+void LeafbarTaskButton::contextMenuEvent(TQContextMenuEvent *cme)
+{
+    m_item->contextMenuEvent(cme);
 }
 
 /* kate: replace-tabs true; tab-width 4; */
\ No newline at end of file
@@ -21,65 +21,67 @@
 
 // TQt
 #include <tqbutton.h>
+#include <tqfont.h>
+#include <tqimage.h>
 
-class LeafbarTaskContainer;
+class LeafbarTaskItem;
+class LeafbarTaskButtonTip;
 
+/* Shows a single task list item in the classic layout and passes it its
+   input events. How items look and the metrics they share are found here as
+   well, as LeafbarTaskView paints them the same way. */
 class LeafbarTaskButton : public TQButton
 {
   TQ_OBJECT
 
   public:
-    enum ButtonType
-    {
-      Task = 0,
-      Grouper,
-      BUTTONTYPE_MAX
-    };
-
-    LeafbarTaskButton(LeafbarTaskContainer *parent, ButtonType type);
+    LeafbarTaskButton(TQWidget *parent, LeafbarTaskItem *item);
     ~LeafbarTaskButton();
 
-    ButtonType buttonType() const { return m_buttonType; }
+    LeafbarTaskItem *item() const { return m_item; }
 
-    virtual TQString name();
-    virtual TQPixmap icon();
+    static void draw(TQPainter *p, LeafbarTaskItem *item, const TQRect &r);
+    static void invalidateIconCache();
 
-    LeafbarTaskContainer *container() const;
-
-    bool showFrame() const;
-    bool showIcon() const;
-    bool useBigIcon() const;
-
-    static TQPixmap defaultIcon(TQSize size = TQSize());
+    static TQImage themeIcon(const TQString &name, int size);
+    static TQImage defaultIcon(TQSize size = TQSize());
 
     static TQSize bigIconSize();
     static TQSize smallIconSize();
 
-    TQSize iconSize() const;
-    TQPoint iconOffset() const;
+    static TQPoint iconMargin(bool bigIcon);
+    static int taskHeight();
 
     static TQFont normalFont();
     static TQFont boldFont();
 
     static TQColor blendColors(const TQColor c1, const TQColor c2);
 
-  public slots:
-    void update();
+    static TQString elide(const TQFontMetrics &fm, const TQString &text, int width);
 
   protected:
     TQSize sizeHint() const;
 
-    virtual TQFont font();
-    virtual TQColorGroup colors();
+    void drawButton(TQPainter *p);
+    void mousePressEvent(TQMouseEvent *);
+    void mouseReleaseEvent(TQMouseEvent *);
+    void mouseDoubleClickEvent(TQMouseEvent *);
+    void mouseMoveEvent(TQMouseEvent *);
+    void enterEvent(TQEvent *);
+    void leaveEvent(TQEvent *);
+    void contextMenuEvent(TQContextMenuEvent *);
+
     static TQPoint smallIconOffset();
 
-    void drawButtonLabel(TQPainter *p);
-    void drawButton(TQPainter *p);
+    static TQImage scaledIcon(LeafbarTaskItem *item);
+    static void drawIcon(TQPainter *p, LeafbarTaskItem *item, const TQPoint &pos);
+    static void drawLabel(TQPainter *p, LeafbarTaskItem *item, const TQRect &r);
 
   private:
-    ButtonType m_buttonType;
+    LeafbarTaskItem *m_item;
+    LeafbarTaskButtonTip *m_tip;
 };
 
 #endif // _LEAFBAR_TASK_BUTTON_H
 
-/* kate: replace-tabs true; tab-width 2; */
\ No newline at end of file
+/* kate: replace-tabs true; tab-width 2; */
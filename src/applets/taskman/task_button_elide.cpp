@@ -0,0 +1,53 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+/* Kept apart from the rest of LeafbarTaskButton so that the elide benchmark
+   can link it without the applet. */
+
+// TQt
+#include <tqfontmetrics.h>
+
+// Leafbar
+#include "task_button.h"
+
+/* Returns text cut down to fit in width pixels, with an ellipsis appended if
+   anything was cut. The cut point is found by bisection, as the width of a
+   prefix can only grow with its length. */
+TQString LeafbarTaskButton::elide(const TQFontMetrics &fm, const TQString &text, int width)
+{
+    if (fm.width(text) <= width)
+    {
+        return text;
+    }
+
+    TQString ellipsis = TQString::fromUtf8("…");
+    int space = width - fm.width(ellipsis);
+
+    // Longest prefix that fits is within [lo, hi]
+    int lo = 0, hi = text.length() - 1;
+    while (lo < hi)
+    {
+        int mid = (lo + hi + 1) / 2;
+        if (fm.width(text, mid) <= space) lo = mid;
+        else hi = mid - 1;
+    }
+
+    return text.left(lo) + ellipsis;
+}
+
+/* kate: replace-tabs true; tab-width 4; */
@@ -17,8 +17,8 @@
 *******************************************************************************/
 
 // TQt
-#include <tqobjectlist.h>
 #include <tqtimer.h>
+#include <tqvbox.h>
 
 // TDE
 #include <tdeapplication.h>
@@ -32,25 +32,54 @@
 // Leafbar
 #include "task_grouper.h"
 #include "task.h"
+#include "task_service_index.h"
 #include "utils.h"
 #include "task_container.h"
 #include "task_container.moc"
 
+// Lays out the buttons of a container in the classic layout
+class LeafbarTaskBox : public TQVBox
+{
+  public:
+    LeafbarTaskBox(LeafbarTaskContainer *container, TQWidget *parent)
+      : TQVBox(parent),
+        m_container(container)
+    {
+        setSizePolicy(TQSizePolicy::MinimumExpanding, TQSizePolicy::Fixed);
+    }
+
+    TQSize sizeHint() const
+    {
+        return TQSize(width(), m_container->height());
+    }
+
+  private:
+    LeafbarTaskContainer *m_container;
+};
+
 LeafbarTaskContainer::LeafbarTaskContainer(LeafbarTaskMan *parent, TQString wclass, TQString aclass)
-  : TQVBox(parent),
+  : TQObject(parent),
     m_service(nullptr),
     m_wclass(wclass),
     m_aclass(aclass),
     m_appname(aclass),
-    m_active(false)
+    m_box(nullptr),
+    m_iconRevision(0),
+    m_iconFromTask(true),
+    m_active(false),
+    m_releaseTimer(nullptr),
+    m_serial(0),
+    m_visibleCount(0),
+    m_iconifiedCount(0)
 {
-    m_grouper = new LeafbarTaskGrouper(this, manager()->config(), m_appname);
+    m_grouper = new LeafbarTaskGrouper(this, m_appname);
 
-    connect(manager(), TQ_SIGNAL(windowActivated(WId)), TQ_SLOT(updateActiveTask(WId)));
     connect(m_grouper, TQ_SIGNAL(pinChanged(bool)), TQ_SLOT(slotPinChanged(bool)));
 
-    setSizePolicy(TQSizePolicy::MinimumExpanding, TQSizePolicy::Fixed);
-    show();
+    if (!manager()->view())
+    {
+        createBox();
+    }
 }
 
 LeafbarTaskContainer::LeafbarTaskContainer(LeafbarTaskMan *parent, KService::Ptr service, TQString aclass)
@@ -62,114 +91,191 @@ LeafbarTaskContainer::LeafbarTaskContainer(LeafbarTaskMan *parent, KService::Ptr
 
 LeafbarTaskContainer::~LeafbarTaskContainer()
 {
+    // Tasks still around are deleted along with us as child objects
+    TaskList::ConstIterator it;
+    for (it = m_tasks.begin(); it != m_tasks.end(); ++it)
+    {
+        (*it)->m_container = nullptr;
+    }
+    m_tasks.clear();
+
     ZAP(m_grouper)
+    deleteBox();
 }
 
-TQObjectList LeafbarTaskContainer::tasks() const
+void LeafbarTaskContainer::createBox()
 {
-    return *(queryList("LeafbarTask"));
+    if (m_box) return;
+
+    m_box = new LeafbarTaskBox(this, manager());
+    m_grouper->createButton(m_box);
+    updateTaskVisibility();
+    m_box->show();
 }
 
-uint LeafbarTaskContainer::count() const
+/* The buttons go along with the box */
+void LeafbarTaskContainer::deleteBox()
 {
-    return tasks().count();
+    ZAP(m_box)
 }
 
-TQObjectList LeafbarTaskContainer::visibleTasks() const
+void LeafbarTaskContainer::scheduleReleaseWidgets()
 {
-    TQObjectList visibleList;
-    FOREACH_TASK(t, tasks())
+    if (!m_releaseTimer)
     {
-        if (t->isShown())
-        {
-            visibleList.append(t);
-        }
+        m_releaseTimer = new TQTimer(this);
+        connect(m_releaseTimer, TQ_SIGNAL(timeout()), TQ_SLOT(releaseWidgets()));
+    }
+    m_releaseTimer->start(TASK_WIDGET_RELEASE_DELAY, true);
+}
+
+/* A collapsed grouper only needs the task records; their buttons are
+   created again when it is expanded (see LeafbarTask::updateVisibility()). */
+void LeafbarTaskContainer::releaseWidgets()
+{
+    if (m_grouper->expanded()) return;
+
+    TaskList::ConstIterator it;
+    for (it = m_tasks.begin(); it != m_tasks.end(); ++it)
+    {
+        (*it)->releaseButton();
     }
-    END_FOREACH_TASK
-    return visibleList;
 }
 
-uint LeafbarTaskContainer::visibleCount() const
+void LeafbarTaskContainer::insertTask(LeafbarTask *t)
 {
-    return visibleTasks().count();
+    m_tasks.append(t);
+    countTask(t, true);
+    if (iconFollows(t)) iconChanged();
 }
 
-TQObjectList LeafbarTaskContainer::currentDesktopTasks() const
+void LeafbarTaskContainer::removeTask(LeafbarTask *t)
 {
-    TQObjectList currentDesktopList;
-    FOREACH_TASK(t, tasks())
+    bool follows = iconFollows(t);
+    if (m_tasks.remove(t))
     {
-        if (t->isOnCurrentDesktop())
+        countTask(t, false);
+    }
+    if (follows) iconChanged();
+}
+
+/* Adds the current state of the task to the counters, or takes it away.
+   Tasks take themselves away before a state change and add themselves back
+   afterwards, so that the counters never need to walk the task list. */
+void LeafbarTaskContainer::countTask(LeafbarTask *t, bool add)
+{
+    if (add)
+    {
+        if (t->isShown()) ++m_visibleCount;
+        if (t->isIconified()) ++m_iconifiedCount;
+        ++m_desktopCounts[t->desktop()];
+    }
+    else
+    {
+        if (t->isShown()) --m_visibleCount;
+        if (t->isIconified()) --m_iconifiedCount;
+        if (--m_desktopCounts[t->desktop()] == 0)
         {
-            currentDesktopList.append(t);
+            m_desktopCounts.remove(t->desktop());
         }
     }
-    END_FOREACH_TASK
-    return currentDesktopList;
 }
 
+uint LeafbarTaskContainer::count() const
+{
+    return m_tasks.count();
+}
+
+/* Tasks on all desktops are counted under desktop 0 */
 uint LeafbarTaskContainer::currentDesktopCount() const
 {
-    return currentDesktopTasks().count();
+    int desktop = manager()->twin()->currentDesktop();
+    uint count = 0;
+
+    TQMap<int, uint>::ConstIterator it = m_desktopCounts.find(0);
+    if (it != m_desktopCounts.end()) count += it.data();
+
+    it = m_desktopCounts.find(desktop);
+    if (desktop != 0 && it != m_desktopCounts.end()) count += it.data();
+
+    return count;
 }
 
-TQSize LeafbarTaskContainer::sizeHint() const
+int LeafbarTaskContainer::height() const
 {
     int height = m_grouper->height();
     if (m_grouper->expanded())
     {
-        FOREACH_TASK(t, tasks())
-        {
-            if (t->isShown())
-            {
-                height += t->height();
-            }
-        }
-        END_FOREACH_TASK
+        height += m_visibleCount * LeafbarTaskButton::taskHeight();
     }
-    return TQSize(width(), height);
+    return height;
 }
 
-TQPixmap LeafbarTaskContainer::groupIcon()
+TQImage LeafbarTaskContainer::groupIcon()
 {
-    TDEIconLoader *il = tdeApp->iconLoader();
-    TQPixmap pix;
-    int size = LeafbarTask::bigIconSize().height();
+    TQImage pix;
+    int size = LeafbarTaskButton::bigIconSize().height();
 
     // First we have some common overrides for system components
     // that do not have their own (user-visible) desktop files
     if (windowClass() == "kdesktop")
     {
-        pix = il->loadIcon("desktop", TDEIcon::Panel, size);
+        pix = LeafbarTaskButton::themeIcon("desktop", size);
     }
-    if (!pix.isNull()) return pix;
 
     // If we have identified the service, check its desktop file value
-    if (m_service)
+    if (pix.isNull() && m_service)
     {
         TDEDesktopFile desktopFile(m_service->desktopEntryPath());
-        pix = il->loadIcon(desktopFile.readIcon(), TDEIcon::Panel, size);
+        pix = LeafbarTaskButton::themeIcon(desktopFile.readIcon(), size);
     }
 
+    m_iconFromTask = pix.isNull();
     if (!pix.isNull())
     {
         return pix;
     }
 
     // Otherwise get the icon of the first task
-    TQObjectList taskList = tasks();
-    if (taskList.count())
+    if (!m_tasks.isEmpty())
     {
-        LeafbarTask *task = static_cast<LeafbarTask *>(taskList.getFirst());
-        return task->icon(LeafbarTask::bigIconSize());
+        pix = m_tasks.first()->ownIcon(LeafbarTaskButton::bigIconSize());
     }
 
     // If all of the above fail, fallback to default icon
-    return LeafbarTask::defaultIcon(LeafbarTask::bigIconSize());
+    return pix.isNull() ? LeafbarTaskButton::defaultIcon(LeafbarTaskButton::bigIconSize()) : pix;
+}
+
+/* Whether the group icon is taken from the given task, so that it changes
+   along with the icon of the task. Until the group icon has been looked up
+   this is assumed for the first task. */
+bool LeafbarTaskContainer::iconFollows(const LeafbarTask *t) const
+{
+    return m_iconFromTask && !m_tasks.isEmpty() && m_tasks.first() == t;
+}
+
+/* Called whenever the group icon may have changed: when the service has been
+   (re)resolved or when the task it is taken from changed (see iconFollows()).
+   Of the tasks only those without an icon of their own paint the group icon
+   and need repainting. */
+void LeafbarTaskContainer::iconChanged()
+{
+    ++m_iconRevision;
+    m_grouper->scheduleRepaint();
+
+    TaskList::ConstIterator it;
+    for (it = m_tasks.begin(); it != m_tasks.end(); ++it)
+    {
+        if ((*it)->isShown() && !(*it)->hasOwnIcon())
+        {
+            (*it)->scheduleRepaint();
+        }
+    }
 }
 
 void LeafbarTaskContainer::slotPinChanged(bool pinned)
 {
+    manager()->placeContainer(this);
     emit pinChanged(pinned);
     update();
 }
@@ -181,40 +287,52 @@ void LeafbarTaskContainer::reconfigure()
 
 void LeafbarTaskContainer::repaintAll()
 {
-    TQTimer::singleShot(0, m_grouper, TQ_SLOT(repaint()));
-    FOREACH_TASK(t, tasks())
+    m_grouper->scheduleRepaint();
+    TaskList::ConstIterator it;
+    for (it = m_tasks.begin(); it != m_tasks.end(); ++it)
     {
-        TQTimer::singleShot(0, t, TQ_SLOT(repaint()));
-        ++it;
+        (*it)->scheduleRepaint();
     }
-    END_FOREACH_TASK
 }
 
 void LeafbarTaskContainer::update()
 {
-    if (!tasks().count() && !isPinned())
+    // Brought up to date once all windows are in (see LeafbarTaskMan::populate())
+    if (manager()->populating()) return;
+
+    if (m_tasks.isEmpty() && !isPinned())
     {
         manager()->removeContainer(this);
         return;
     }
 
-    TQTimer::singleShot(0, manager(), TQ_SLOT(relayout()));
+    deferredCalls->call(manager(), TQ_SLOT(relayout()));
+
+    // Our lowest desktop changes as tasks come and go
+    if (manager()->sortOrder() == LeafbarTaskMan::SortDesktop)
+    {
+        manager()->placeContainer(this);
+    }
 
     // No point in trying too hard for some cases
     TQString aClass = applicationClass();
     if (aClass == "Kdesktop" || aClass == "Kded" || aClass == "Ksmserver")
     {
-        m_appname = i18n("TDE Desktop");
+        setApplication(i18n("TDE Desktop"));
         return;
     }
 
     if (!m_service)
     {
         findService();
+        if (m_service) iconChanged();
     }
 
-    if (m_service)
+    // The name only needs reading once per service
+    if (m_service && m_service != m_namedService)
     {
+        m_namedService = m_service;
+
         TDEDesktopFile desktopFile(desktopPath().path());
         TQString appname = desktopFile.readName();
         if (appname.isNull())
@@ -227,110 +345,127 @@ void LeafbarTaskContainer::update()
             appname = windowClass();
         }
 
-        m_appname = appname;
+        setApplication(appname);
     }
 }
 
-void LeafbarTaskContainer::findService()
+/* The name may decide our place in the task list (see
+   LeafbarTaskMan::placeContainer()) */
+void LeafbarTaskContainer::setApplication(const TQString &appname)
 {
-    if (m_service) return;
+    if (appname == m_appname) return;
 
-    FOREACH_TASK(t, tasks())
+    m_appname = appname;
+    if (manager()->sortOrder() == LeafbarTaskMan::SortName)
     {
-        // Common special cases
-        if (t->className() == "tdecmshell")
-        {
-            m_service = KService::serviceByDesktopName("kcontrol");
-        }
-        if (m_service) return;
+        manager()->placeContainer(this);
+    }
+}
 
-        // Query desktop files via KSycoca
-        m_service = KService::serviceByStorageId(t->classClass());
-        if (m_service) return;
+/* Lowest desktop any of our tasks is on, or -1 if we have no tasks */
+int LeafbarTaskContainer::desktop() const
+{
+    if (m_desktopCounts.isEmpty()) return -1;
+    return m_desktopCounts.begin().key();
+}
 
-        m_service = KService::serviceByName(t->classClass());
-        if (m_service) return;
+void LeafbarTaskContainer::findService()
+{
+    if (m_service) return;
 
-        m_service = KService::serviceByStorageId(t->executable());
-        if (m_service) return;
+    LeafbarTaskServiceIndex *index = LeafbarTaskServiceIndex::instance();
+    TaskList::ConstIterator it;
+    for (it = m_tasks.begin(); it != m_tasks.end(); ++it)
+    {
+        LeafbarTask *t = (*it);
+        TQString key = LeafbarTaskServiceIndex::classKey(
+                           t->classClass(), t->className(), t->executablePath());
 
-        // Last resort: find KSycoca entry by executable name/path
-        KService::List all = KService::allServices();
-        KService::List::ConstIterator svc;
-        for (svc = all.begin(); svc != all.end(); ++svc)
+        // Remembered from an earlier run, including failed lookups
+        if (!index->lookupClass(key, &m_service))
         {
-            // Get rid of any argument placeholders might be present
-            TQString exec = TQStringList::split(" ", (*svc)->exec())[0];
-            if (exec == t->executablePath() || exec == t->executable())
-            {
-                m_service = (*svc);
-                return;
-            }
+            m_service = serviceForTask(t);
+            index->rememberClass(key, m_service);
         }
+        if (m_service) return;
     }
-    END_FOREACH_TASK
     kdWarning() << "Unable to find desktop file for application class "
                 << applicationClass() << endl;
 }
 
-void LeafbarTaskContainer::updateActiveTask(WId w)
+KService::Ptr LeafbarTaskContainer::serviceForTask(LeafbarTask *t)
 {
-    bool foundActive = false;
-    FOREACH_TASK(t, tasks())
+    KService::Ptr service;
+
+    // Common special cases
+    if (t->className() == "tdecmshell")
     {
-        bool active = w == t->windowID();
-        t->setOn(active);
-        if (active) foundActive = true;
+        service = KService::serviceByDesktopName("kcontrol");
     }
-    END_FOREACH_TASK
-    m_active = foundActive;
-    TQTimer::singleShot(0, m_grouper, TQ_SLOT(repaint()));
+    if (service) return service;
+
+    // Query desktop files via KSycoca
+    service = KService::serviceByStorageId(t->classClass());
+    if (service) return service;
+
+    service = KService::serviceByName(t->classClass());
+    if (service) return service;
+
+    service = KService::serviceByStorageId(t->executable());
+    if (service) return service;
+
+    // Last resort: find KSycoca entry by executable name/path
+    return LeafbarTaskServiceIndex::instance()->findByExecutable(
+               t->executablePath(), t->executable());
 }
 
-void LeafbarTaskContainer::updateTaskVisibility()
+/* Called by the manager with the task that became active, or with null when
+   our active task lost focus. The previously active task is reset by the
+   manager itself. */
+void LeafbarTaskContainer::setActiveTask(LeafbarTask *t)
 {
-    FOREACH_TASK(t, tasks())
+    if (t) t->setOn(true);
+
+    bool active = (t != nullptr);
+    if (active != m_active)
     {
-        t->updateVisibility();
+        // Task colours depend on whether their container is active
+        m_active = active;
+        repaintAll();
     }
-    END_FOREACH_TASK
-    TQTimer::singleShot(0, manager(), TQ_SLOT(relayout()));
 }
 
-void LeafbarTaskContainer::toggleIconifiedAll()
+void LeafbarTaskContainer::updateTaskVisibility()
 {
-    FOREACH_TASK(t, tasks())
+    TaskList::ConstIterator it;
+    for (it = m_tasks.begin(); it != m_tasks.end(); ++it)
     {
-        t->toggleIconified();
+        (*it)->updateVisibility();
     }
-    END_FOREACH_TASK
+    deferredCalls->call(manager(), TQ_SLOT(relayout()));
 }
 
-void LeafbarTaskContainer::closeAll()
+void LeafbarTaskContainer::toggleIconifiedAll()
 {
-    if (KMessageBox::Yes == KMessageBox::warningYesNo(
-        this, i18n("<qt>Are you sure you want to close all the "
-        "windows of <b>%1</b>?</qt>").arg(application())))
+    TaskList::ConstIterator it;
+    for (it = m_tasks.begin(); it != m_tasks.end(); ++it)
     {
-        FOREACH_TASK(t, tasks())
-        {
-            t->close();
-        }
-        END_FOREACH_TASK
+        (*it)->toggleIconified();
     }
 }
 
-bool LeafbarTaskContainer::allIconified()
+void LeafbarTaskContainer::closeAll()
 {
-    FOREACH_TASK(t, tasks())
+    if (KMessageBox::Yes == KMessageBox::warningYesNo(
+        manager(), i18n("<qt>Are you sure you want to close all the "
+        "windows of <b>%1</b>?</qt>").arg(application())))
     {
-        if (!t->isIconified())
+        TaskList::ConstIterator it;
+        for (it = m_tasks.begin(); it != m_tasks.end(); ++it)
         {
-            return false;
+            (*it)->close();
         }
     }
-    END_FOREACH_TASK
-    return true;
 }
 
 const KURL LeafbarTaskContainer::desktopPath()
@@ -343,6 +478,7 @@ void LeafbarTaskContainer::slotDesktopFileChanged(const KURL& oldUrl, KURL& newU
 {
     if (oldUrl != desktopPath().url() || oldUrl == newUrl) return;
     m_service = new KService(newUrl.path());
+    iconChanged();
     update();
 }
 
@@ -24,22 +24,23 @@
 #include <kurl.h>
 
 // TQt
-#include <tqvbox.h>
+#include <tqobject.h>
 
 // Leafbar
 #include "task_manager.h"
 #include "task_grouper.h"
 
-#define FOREACH_TASK(x, tasks) \
-  TQObjectList taskList = tasks; \
-  TQObjectListIt it(taskList); \
-  LeafbarTask *x; \
-  while ((x = static_cast<LeafbarTask *>(it.current())) != nullptr) {
-#define END_FOREACH_TASK ++it; }
+// How long a grouper stays collapsed before its task widgets are released
+#define TASK_WIDGET_RELEASE_DELAY 30000
 
+class TQTimer;
+class TQVBox;
 class LeafbarTask;
 
-class LeafbarTaskContainer : public TQVBox {
+/* The grouper and tasks of an application. In the classic layout they are
+   shown as buttons in a box of their own (see createBox()); the task view
+   paints them without any widgets. */
+class LeafbarTaskContainer : public TQObject {
   TQ_OBJECT
 
   public:
@@ -52,15 +53,22 @@ class LeafbarTaskContainer : public TQVBox {
     TQString windowClass()      const { return m_wclass; }
     TQString applicationClass() const { return m_aclass; }
     TQString application()      const { return m_appname; }
-    TQPixmap groupIcon();
+    int desktop() const;
 
-    TQObjectList tasks() const;
-    TQObjectList visibleTasks() const;
-    TQObjectList currentDesktopTasks() const;
+    // Order in which the task manager has seen the containers
+    uint serial() const { return m_serial; }
+    void setSerial(uint serial) { m_serial = serial; }
+    TQImage groupIcon();
+    uint iconRevision() const { return m_iconRevision; }
+    bool iconFollows(const LeafbarTask *t) const;
+    void iconChanged();
+
+    const TaskList &tasks() const { return m_tasks; }
 
     uint count() const;
-    uint visibleCount() const;
+    uint visibleCount() const { return m_visibleCount; }
     uint currentDesktopCount() const;
+    uint iconifiedCount() const { return m_iconifiedCount; }
 
     KService::Ptr service() { return m_service; }
     const KURL desktopPath();
@@ -69,38 +77,63 @@ class LeafbarTaskContainer : public TQVBox {
     bool isPinned()   { return m_grouper->pinned(); }
     bool isPinnable() { return m_grouper->pinnable(); }
 
-    bool allIconified();
+    bool allIconified() const { return m_iconifiedCount == count(); }
 
     LeafbarTaskMan *manager() const { return static_cast<LeafbarTaskMan *>(parent()); }
     LeafbarTaskGrouper *grouper() const { return m_grouper; }
     KWinModule *twin() { return manager()->twin(); }
 
+    // Classic layout only, null while the task view is used
+    TQVBox *box() const { return m_box; }
+    void createBox();
+    void deleteBox();
+    int height() const;
+
   public slots:
     void reconfigure();
     void update();
     void updateTaskVisibility();
-    void updateActiveTask(WId w);
+    void setActiveTask(LeafbarTask *t);
     void toggleIconifiedAll();
     void closeAll();
 
+    void scheduleReleaseWidgets();
+    void releaseWidgets();
+
     void slotPinChanged(bool pinned);
     void slotDesktopFileChanged(const KURL&, KURL&);
 
   signals:
     void pinChanged(bool pinned);
 
-  protected:
-    TQSize sizeHint() const;
-
   private:
-    KService::Ptr m_service;
+    KService::Ptr m_service, m_namedService;
     TQString m_wclass, m_aclass, m_appname;
     LeafbarTaskGrouper *m_grouper;
+    TQVBox *m_box;
+    TaskList m_tasks;
+    uint m_iconRevision;
+    bool m_iconFromTask;
     bool m_active;
+    TQTimer *m_releaseTimer;
+    uint m_serial;
+
+    // Kept up to date by the tasks as their state changes (see countTask())
+    uint m_visibleCount, m_iconifiedCount;
+    TQMap<int, uint> m_desktopCounts;
+
+    void setApplication(const TQString &appname);
+    void insertTask(LeafbarTask *t);
+    void removeTask(LeafbarTask *t);
+    void countTask(LeafbarTask *t, bool add);
+
+    KService::Ptr serviceForTask(LeafbarTask *t);
 
   private slots:
     void findService();
     void repaintAll();
+
+  friend class LeafbarTask;
 };
 
 #endif // _LEAFBAR_TASK_CONTAINER_H
@@ -17,7 +17,6 @@
 *******************************************************************************/
 
 // TQt
-#include <tqobjectlist.h>
 #include <tqpainter.h>
 #include <tqstyle.h>
 #include <tqtimer.h>
@@ -34,14 +33,15 @@
 // Leafbar
 #include "task.h"
 #include "task_container.h"
+#include "task_icon_atlas.h"
 #include "task_grouper.h"
 #include "task_grouper.moc"
 
-static TQPixmap *pxLink = nullptr;
+// Atlas key of the link overlay of pinned groupers
+#define GROUPER_LINK_ICON "grouper-link"
 
-LeafbarTaskGrouper::LeafbarTaskGrouper(LeafbarTaskContainer *parent, TDEConfig *cfg, TQString name)
-  : LeafbarTaskButton(parent, LeafbarTaskButton::Grouper),
-    m_config(cfg),
+LeafbarTaskGrouper::LeafbarTaskGrouper(LeafbarTaskContainer *parent, TQString name)
+  : LeafbarTaskItem(parent),
     m_expanded(true),
     m_pinned(false)
 {
@@ -54,53 +54,52 @@ LeafbarTaskGrouper::~LeafbarTaskGrouper()
 {
 }
 
+LeafbarTaskContainer *LeafbarTaskGrouper::container() const
+{
+    return static_cast<LeafbarTaskContainer *>(parent());
+}
+
 LeafbarTaskMan* LeafbarTaskGrouper::manager() const
 {
     return container()->manager();
 }
 
-#define ICON(iconVar, icon, group, size) \
-    if (!iconVar || iconVar->isNull()) iconVar = new TQPixmap( \
-        tdeApp->iconLoader()->loadIcon( \
-            icon, group, size.height(), TDEIcon::DefaultState, nullptr, true \
-        ) \
-    );
-#define ICON_SMALL(iconVar, icon) \
-    ICON(iconVar, icon, TDEIcon::Small, smallIconSize())
-#define ICON_BIG(iconVar, icon) \
-    ICON(iconVar, icon, TDEIcon::Panel, bigIconSize())
-
+/* The link overlay stays in the icon atlas for good */
 void LeafbarTaskGrouper::updateStaticPixmaps()
 {
-    ICON_BIG(pxLink, tdeApp->iconLoader()->theme()->linkOverlay())
+    LeafbarTaskIconAtlas *atlas = LeafbarTaskIconAtlas::instance();
+    if (atlas->contains(GROUPER_LINK_ICON)) return;
+
+    atlas->insert(GROUPER_LINK_ICON,
+                  LeafbarTaskButton::themeIcon(tdeApp->iconLoader()->theme()->linkOverlay(),
+                                               LeafbarTaskButton::bigIconSize().height()));
 }
-#undef ICON
-#undef ICON_SMALL
-#undef ICON_BIG
 
 TQString LeafbarTaskGrouper::name()
 {
     return container()->application();
 }
 
-TQPixmap LeafbarTaskGrouper::icon()
+TQImage LeafbarTaskGrouper::icon()
 {
-    TQPixmap groupIcon = container()->groupIcon();
-    return groupIcon.isNull() ? defaultIcon() : groupIcon;
+    TQImage groupIcon = container()->groupIcon();
+    return groupIcon.isNull() ? LeafbarTaskButton::defaultIcon() : groupIcon;
+}
+
+TQString LeafbarTaskGrouper::iconCacheKey()
+{
+    return TQString("grouper-%1-%2").arg(container()->applicationClass())
+                                    .arg(container()->iconRevision());
 }
 
 bool LeafbarTaskGrouper::autoExpand()
 {
-    m_config->setGroup("TaskGroupers");
-    return m_config->readBoolEntry(container()->applicationClass(),
-                                   manager()->defaultExpandGroupers());
+    return manager()->grouperAutoExpand(container()->applicationClass());
 }
 
 void LeafbarTaskGrouper::setAutoExpand(bool autoExpand)
 {
-    m_config->setGroup("TaskGroupers");
-    m_config->writeEntry(container()->applicationClass(), autoExpand);
-    m_config->sync();
+    manager()->setGrouperAutoExpand(container()->applicationClass(), autoExpand);
 }
 
 void LeafbarTaskGrouper::toggleAutoExpand()
@@ -121,16 +120,20 @@ void LeafbarTaskGrouper::loadState()
 void LeafbarTaskGrouper::setExpanded(bool expanded, bool dontSave)
 {
     m_expanded = expanded;
-    setOn(m_expanded);
-
-    TQTimer::singleShot(0, this, TQ_SLOT(repaint()));
+    scheduleRepaint();
 
     // hide/show tasks
-    FOREACH_TASK(t, container()->tasks())
+    const TaskList &tasks = container()->tasks();
+    TaskList::ConstIterator it;
+    for (it = tasks.begin(); it != tasks.end(); ++it)
     {
-        t->updateVisibility();
+        (*it)->updateVisibility();
+    }
+
+    if (!m_expanded)
+    {
+        container()->scheduleReleaseWidgets();
     }
-    END_FOREACH_TASK
 
     if (!dontSave && manager()->autoSaveGroupers())
     {
@@ -147,28 +150,39 @@ void LeafbarTaskGrouper::pin()
 {
     if (!pinnable()) return;
     m_pinned = true;
-    TQTimer::singleShot(0, this, TQ_SLOT(repaint()));
+    scheduleRepaint();
     emit pinChanged(true);
 }
 
 void LeafbarTaskGrouper::unpin()
 {
     m_pinned = false;
-    TQTimer::singleShot(0, this, TQ_SLOT(repaint()));
+    scheduleRepaint();
     emit pinChanged(false);
 }
 
+bool LeafbarTaskGrouper::showFrame() const
+{
+    return true;
+}
+
+bool LeafbarTaskGrouper::useBigIcon() const
+{
+    return manager()->bigGrouperIcons();
+}
+
 TQFont LeafbarTaskGrouper::font()
 {
-    return container()->isActive() ? boldFont() : normalFont() ;
+    return container()->isActive() ? LeafbarTaskButton::boldFont()
+                                   : LeafbarTaskButton::normalFont();
 }
 
 TQColorGroup LeafbarTaskGrouper::colors()
 {
-    TQColorGroup cg = LeafbarTaskButton::colors();
+    TQColorGroup cg = LeafbarTaskItem::colors();
     if (container()->isActive())
     {
-      TQColor highlight = blendColors(cg.button(), cg.highlight());
+      TQColor highlight = LeafbarTaskButton::blendColors(cg.button(), cg.highlight());
       cg.setColor(TQColorGroup::Button,     highlight);
       cg.setColor(TQColorGroup::Background, highlight);
       cg.setColor(TQColorGroup::ButtonText, cg.highlightedText());
@@ -176,27 +190,25 @@ TQColorGroup LeafbarTaskGrouper::colors()
     return cg;
 }
 
-void LeafbarTaskGrouper::drawButton(TQPainter *p)
+void LeafbarTaskGrouper::drawOverlay(TQPainter *p, const TQRect &r)
 {
-    LeafbarTaskButton::drawButton(p);
-
     // arrow
     if (container()->count() > 0 &&
         (manager()->showAllDesktops() || container()->currentDesktopCount() > 0))
     {
-        int h = height();
-        TQRect r(width() - h, 0, h, h);
-        style().drawPrimitive(
+        int h = r.height();
+        TQRect arrow(r.right() - h + 1, r.top(), h, h);
+        tdeApp->style().drawPrimitive(
           expanded() ? TQStyle::PE_ArrowUp : TQStyle::PE_ArrowDown,
-          p, r, colorGroup()
+          p, arrow, colors()
         );
     }
 
     // link
     if (m_pinned)
     {
-        TQPoint origin = TQPoint(iconOffset());
-        p->drawPixmap(origin, *pxLink);
+        TQPoint origin = r.topLeft() + iconOffset();
+        LeafbarTaskIconAtlas::instance()->draw(p, origin, GROUPER_LINK_ICON);
     }
 }
 
@@ -230,7 +242,7 @@ void LeafbarTaskGrouper::contextMenuEvent(TQContextMenuEvent *cme)
     }
     ctx.insertItem(SmallIcon("configure"), i18n("Grouper options"), &opts);
 
-    if (container()->tasks().count())
+    if (container()->count())
     {
         item = ctx.insertItem(SmallIcon("taskbar"), i18n("Minimize all"),
                               container(), TQ_SLOT(toggleIconifiedAll()));
@@ -260,7 +272,7 @@ void LeafbarTaskGrouper::mousePressEvent(TQMouseEvent *me)
     switch (me->button())
     {
         case LeftButton:
-            if (!container()->tasks().count()) return;
+            if (!container()->count()) return;
 
             if (me->state() & (ControlButton | AltButton))
             {
@@ -284,9 +296,9 @@ void LeafbarTaskGrouper::mouseDoubleClickEvent(TQMouseEvent *me) {
     if (me->button() == LeftButton && container()->service()) {
         panelExt->launch(container()->service());
 
-        // HACK the second click gets consumed
-        if (container()->tasks().count() && !(me->state() & ControlButton)) {
-            toggle();
+        // The first click of the double click has toggled us already
+        if (container()->count() && !(me->state() & ControlButton)) {
+            setExpanded(!expanded());
         }
     }
     me->ignore();
@@ -299,7 +311,7 @@ void LeafbarTaskGrouper::showPropertiesDialog() {
                     << "does not have a desktop entry!" << endl;
         return;
     }
-    KPropertiesDialog *d = new KPropertiesDialog(KURL(path), this);
+    KPropertiesDialog *d = new KPropertiesDialog(KURL(path), manager());
     auto c = container();
     connect(d, TQ_SIGNAL(applied()),
             c, TQ_SLOT(update()));
@@ -20,20 +20,34 @@
 #define _LEAFBAR_TASK_GROUPER_H
 
 // Leafbar
+#include "task_item.h"
 #include "task_button.h"
 
 class LeafbarTaskContainer;
 class LeafbarTaskMan;
 
-class LeafbarTaskGrouper : public LeafbarTaskButton {
+class LeafbarTaskGrouper : public LeafbarTaskItem {
   TQ_OBJECT
 
   public:
-    LeafbarTaskGrouper(LeafbarTaskContainer *parent, TDEConfig *cfg, TQString name);
+    LeafbarTaskGrouper(LeafbarTaskContainer *parent, TQString name);
     ~LeafbarTaskGrouper();
 
+    LeafbarTaskContainer *container() const;
+
     TQString name();
-    TQPixmap icon();
+    TQImage icon();
+    TQString iconCacheKey();
+    bool isOn() const { return m_expanded; }
+
+    bool showFrame() const;
+    bool useBigIcon() const;
+    TQFont font();
+    TQColorGroup colors();
+
+    void contextMenuEvent(TQContextMenuEvent *);
+    void mousePressEvent(TQMouseEvent *);
+    void mouseDoubleClickEvent(TQMouseEvent *);
 
     bool expanded() { return m_expanded; }
     void setExpanded(bool expanded, bool dontSave = false);
@@ -57,15 +71,9 @@ class LeafbarTaskGrouper : public LeafbarTaskButton {
     void toggleAutoExpand();
 
   protected:
-    TQFont font();
-    TQColorGroup colors();
-    void drawButton(TQPainter *p);
-    void contextMenuEvent(TQContextMenuEvent *);
-    void mousePressEvent(TQMouseEvent *);
-    void mouseDoubleClickEvent(TQMouseEvent *);
+    void drawOverlay(TQPainter *p, const TQRect &r);
 
   private:
-    TDEConfig *m_config;
     bool m_expanded;
     bool m_pinned;
 
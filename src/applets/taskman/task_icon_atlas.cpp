@@ -0,0 +1,218 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+// TQt
+#include <tqpainter.h>
+
+// Leafbar
+#include "task_icon_atlas.h"
+
+static LeafbarTaskIconAtlas *leafbarTaskIconAtlas = nullptr;
+LeafbarTaskIconAtlas *LeafbarTaskIconAtlas::instance() {
+    if (!leafbarTaskIconAtlas) {
+        leafbarTaskIconAtlas = new LeafbarTaskIconAtlas();
+    }
+    return leafbarTaskIconAtlas;
+}
+
+LeafbarTaskIconAtlas::LeafbarTaskIconAtlas()
+: m_uploads(0)
+{
+}
+
+LeafbarTaskIconAtlas::~LeafbarTaskIconAtlas()
+{
+    TQValueList<Page *>::Iterator it;
+    for (it = m_pages.begin(); it != m_pages.end(); ++it)
+    {
+        delete (*it);
+    }
+}
+
+bool LeafbarTaskIconAtlas::acquire(const TQString &key)
+{
+    TQMap<TQString, Entry>::Iterator it = m_entries.find(key);
+    if (it == m_entries.end()) return false;
+
+    ++it.data().refs;
+    return true;
+}
+
+void LeafbarTaskIconAtlas::insert(const TQString &key, const TQImage &img)
+{
+    if (acquire(key)) return;
+
+    Entry e;
+    e.page = nullptr;
+    e.slot = -1;
+    e.refs = 1;
+
+    // A null icon takes no cell and paints nothing
+    if (!img.isNull())
+    {
+        e.page = pageFor(img.size(), &e.slot);
+
+        TQImage icon = img.convertDepth(32);
+        TQRect r = cellRect(e);
+        bitBlt(&e.page->image, r.x(), r.y(), &icon, 0, 0, r.width(), r.height());
+        e.page->dirty.setBit(e.slot);
+        ++e.page->dirtyCount;
+    }
+
+    m_entries.insert(key, e);
+}
+
+void LeafbarTaskIconAtlas::release(const TQString &key)
+{
+    TQMap<TQString, Entry>::Iterator it = m_entries.find(key);
+    if (it == m_entries.end()) return;
+
+    Entry &e = it.data();
+    if (--e.refs > 0) return;
+
+    Page *page = e.page;
+    m_entries.remove(it);
+    if (!page) return;
+
+    // Leave the stale pixels, the next icon in this cell overwrites them
+    page->used.clearBit(e.slot);
+    if (page->dirty.testBit(e.slot))
+    {
+        page->dirty.clearBit(e.slot);
+        --page->dirtyCount;
+    }
+    if (--page->count == 0)
+    {
+        m_pages.remove(page);
+        delete page;
+    }
+}
+
+void LeafbarTaskIconAtlas::draw(TQPainter *p, const TQPoint &pos, const TQString &key)
+{
+    TQMap<TQString, Entry>::ConstIterator it = m_entries.find(key);
+    if (it == m_entries.end() || !it.data().page) return;
+
+    Page *page = it.data().page;
+    if (page->dirtyCount > 0)
+    {
+        upload(page);
+    }
+
+    p->drawPixmap(pos, page->pixmap, cellRect(it.data()));
+}
+
+/* Copies the cells written since the last upload into the page pixmap.
+   bitBlt() would only copy the colours and leave the page transparent there,
+   so each cell goes through a pixmap of its own, which copyBlt() copies
+   along with its alpha channel or mask. */
+void LeafbarTaskIconAtlas::upload(Page *page)
+{
+    const int slots = ICON_ATLAS_COLUMNS * ICON_ATLAS_ROWS;
+    for (int i = 0; i < slots && page->dirtyCount > 0; ++i)
+    {
+        if (!page->dirty.testBit(i)) continue;
+
+        TQRect r = cellRect(page, i);
+        TQPixmap cell;
+        cell.convertFromImage(page->image.copy(r));
+        copyBlt(&page->pixmap, r.x(), r.y(), &cell, 0, 0, r.width(), r.height());
+        page->dirty.clearBit(i);
+        --page->dirtyCount;
+        ++m_uploads;
+    }
+}
+
+ulong LeafbarTaskIconAtlas::pixmapBytes() const
+{
+    ulong bytes = 0;
+    TQValueList<Page *>::ConstIterator it;
+    for (it = m_pages.begin(); it != m_pages.end(); ++it)
+    {
+        const TQPixmap &pm = (*it)->pixmap;
+        bytes += (ulong)pm.width() * pm.height() * ((pm.depth() + 7) / 8);
+    }
+    return bytes;
+}
+
+ulong LeafbarTaskIconAtlas::imageBytes() const
+{
+    ulong bytes = 0;
+    TQValueList<Page *>::ConstIterator it;
+    for (it = m_pages.begin(); it != m_pages.end(); ++it)
+    {
+        bytes += (*it)->image.numBytes();
+    }
+    return bytes;
+}
+
+/* Returns a page for icons of the given size with a free cell, which is
+   marked as used and returned in slot. */
+LeafbarTaskIconAtlas::Page *LeafbarTaskIconAtlas::pageFor(const TQSize &cell, int *slot)
+{
+    const int slots = ICON_ATLAS_COLUMNS * ICON_ATLAS_ROWS;
+
+    Page *page = nullptr;
+    TQValueList<Page *>::Iterator it;
+    for (it = m_pages.begin(); it != m_pages.end(); ++it)
+    {
+        if ((*it)->cell == cell && (*it)->count < (uint)slots)
+        {
+            page = (*it);
+            break;
+        }
+    }
+
+    if (!page)
+    {
+        page = new Page;
+        page->cell = cell;
+        page->image.create(cell.width() * ICON_ATLAS_COLUMNS,
+                           cell.height() * ICON_ATLAS_ROWS, 32);
+        page->image.setAlphaBuffer(true);
+        page->image.fill(0);
+        page->used.resize(slots);
+        page->used.fill(false);
+        page->dirty.resize(slots);
+        page->dirty.fill(false);
+        page->count = 0;
+        page->dirtyCount = 0;
+
+        // The page pixmap is allocated once, fully transparent
+        page->pixmap.convertFromImage(page->image);
+        m_pages.append(page);
+    }
+
+    int i = 0;
+    while (page->used.testBit(i)) ++i;
+
+    page->used.setBit(i);
+    ++page->count;
+    *slot = i;
+    return page;
+}
+
+TQRect LeafbarTaskIconAtlas::cellRect(const Page *page, int slot) const
+{
+    TQSize cell = page->cell;
+    return TQRect((slot % ICON_ATLAS_COLUMNS) * cell.width(),
+                  (slot / ICON_ATLAS_COLUMNS) * cell.height(),
+                  cell.width(), cell.height());
+}
+
+/* kate: replace-tabs true; tab-width 4; */
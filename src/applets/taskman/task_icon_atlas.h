@@ -0,0 +1,99 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+#ifndef _LEAFBAR_TASK_ICON_ATLAS_H
+#define _LEAFBAR_TASK_ICON_ATLAS_H
+
+// TQt
+#include <tqmap.h>
+#include <tqvaluelist.h>
+#include <tqbitarray.h>
+#include <tqimage.h>
+#include <tqpixmap.h>
+
+class TQPainter;
+
+// Icons per atlas page are ICON_ATLAS_COLUMNS x ICON_ATLAS_ROWS
+#define ICON_ATLAS_COLUMNS 8
+#define ICON_ATLAS_ROWS 8
+
+/* Keeps the icons painted by task buttons and groupers in a few large pixmaps,
+   one set of pages per icon size, instead of one server side pixmap per icon.
+   Icons are reference counted by key and their cell is reused once the last
+   user lets go of them; pages that become empty are freed.
+
+   Pages are composed client side. Each page keeps a server side pixmap for
+   its whole life, and the cells written since the last paint are copied into
+   it the next time the page is painted from. */
+class LeafbarTaskIconAtlas
+{
+  public:
+    static LeafbarTaskIconAtlas *instance();
+
+    // Adds a reference to an icon already in the atlas, if it is there
+    bool acquire(const TQString &key);
+    // Adds an icon with a single reference
+    void insert(const TQString &key, const TQImage &img);
+    void release(const TQString &key);
+
+    bool contains(const TQString &key) const { return m_entries.contains(key); }
+    void draw(TQPainter *p, const TQPoint &pos, const TQString &key);
+
+    uint iconCount() const { return m_entries.count(); }
+    uint pageCount() const { return m_pages.count(); }
+    // Memory taken by the page pixmaps on the X server and images client side
+    ulong pixmapBytes() const;
+    ulong imageBytes() const;
+    // Number of cells copied to the server so far
+    ulong uploads() const { return m_uploads; }
+
+  private:
+    LeafbarTaskIconAtlas();
+    ~LeafbarTaskIconAtlas();
+
+    struct Page
+    {
+      TQSize cell;
+      TQImage image;
+      TQPixmap pixmap;
+      TQBitArray used;
+      TQBitArray dirty;
+      uint count;
+      uint dirtyCount;
+    };
+
+    struct Entry
+    {
+      Page *page;
+      int slot;
+      uint refs;
+    };
+
+    TQValueList<Page *> m_pages;
+    TQMap<TQString, Entry> m_entries;
+    ulong m_uploads;
+
+    Page *pageFor(const TQSize &cell, int *slot);
+    TQRect cellRect(const Page *page, int slot) const;
+    TQRect cellRect(const Entry &e) const { return cellRect(e.page, e.slot); }
+    void upload(Page *page);
+};
+
+#endif // _LEAFBAR_TASK_ICON_ATLAS_H
+
+/* kate: replace-tabs true; tab-width 2; */
@@ -0,0 +1,196 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+// TQt
+#include <tqevent.h>
+#include <tqfontmetrics.h>
+
+// Leafbar
+#include "task_container.h"
+#include "task_view.h"
+#include "task_icon_atlas.h"
+#include "task_button.h"
+#include "task_item.h"
+#include "task_item.moc"
+
+static const uint statRepaintsSkipped = LeafbarAppletStats::key("repaintsSkipped");
+
+LeafbarTaskItem::LeafbarTaskItem(TQObject *parent)
+  : TQObject(parent),
+    m_elideWidth(-1)
+{
+}
+
+LeafbarTaskItem::~LeafbarTaskItem()
+{
+    releaseButton();
+    LeafbarTaskIconAtlas::instance()->release(m_atlasKey);
+}
+
+void LeafbarTaskItem::createButton(TQWidget *parent)
+{
+    if (m_button) return;
+    m_button = new LeafbarTaskButton(parent, this);
+}
+
+void LeafbarTaskItem::releaseButton()
+{
+    if (!m_button) return;
+
+    delete (LeafbarTaskButton *)m_button;
+    m_button = nullptr;
+}
+
+/* Repaint if the label or icon we would paint now differ from the painted
+   ones. Titles often change in parts that are elided anyway. */
+void LeafbarTaskItem::update()
+{
+    if (labelChanged())
+    {
+        scheduleRepaint();
+    }
+    else
+    {
+        container()->manager()->stats()->count(statRepaintsSkipped);
+    }
+}
+
+bool LeafbarTaskItem::labelChanged()
+{
+    // Not painted yet
+    if (m_elideWidth < 0) return true;
+
+    if (iconCacheKey() != m_paintedIconKey || font() != m_elideFont)
+    {
+        return true;
+    }
+
+    TQString label(name());
+    if (label == m_elideText) return false;
+
+    if (LeafbarTaskButton::elide(TQFontMetrics(m_elideFont), label, m_elideWidth) != m_elided)
+    {
+        return true;
+    }
+
+    m_elideText = label;
+    return false;
+}
+
+/* Schedule a repaint of our button, or of the task view that paints us in
+   its stead (see LeafbarTaskView). */
+void LeafbarTaskItem::scheduleRepaint()
+{
+    LeafbarTaskView *view = container()->manager()->view();
+    if (view)
+    {
+        deferredCalls->call(view, TQ_SLOT(update()));
+    }
+    else if (m_button)
+    {
+        deferredCalls->call(m_button, TQ_SLOT(repaint()));
+    }
+}
+
+/* Identifies the current icon of this item in the icon atlas; it must change
+   whenever icon() would return something different. A null key disables
+   caching. */
+TQString LeafbarTaskItem::iconCacheKey()
+{
+    return TQString::null;
+}
+
+bool LeafbarTaskItem::showFrame() const
+{
+    return false;
+}
+
+bool LeafbarTaskItem::showIcon() const
+{
+    return true;
+}
+
+bool LeafbarTaskItem::useBigIcon() const
+{
+    return false;
+}
+
+TQFont LeafbarTaskItem::font()
+{
+    return LeafbarTaskButton::normalFont();
+}
+
+TQColorGroup LeafbarTaskItem::colors()
+{
+    return container()->manager()->palette().active();
+}
+
+TQSize LeafbarTaskItem::iconSize() const
+{
+    return (useBigIcon() ? LeafbarTaskButton::bigIconSize()
+                         : LeafbarTaskButton::smallIconSize());
+}
+
+TQPoint LeafbarTaskItem::iconOffset() const
+{
+    return LeafbarTaskButton::iconMargin(useBigIcon());
+}
+
+int LeafbarTaskItem::height() const
+{
+    return iconSize().height() + (iconOffset().y() * 2);
+}
+
+void LeafbarTaskItem::drawOverlay(TQPainter *, const TQRect &)
+{
+}
+
+void LeafbarTaskItem::mousePressEvent(TQMouseEvent *me)
+{
+    me->ignore();
+}
+
+void LeafbarTaskItem::mouseReleaseEvent(TQMouseEvent *me)
+{
+    me->ignore();
+}
+
+void LeafbarTaskItem::mouseDoubleClickEvent(TQMouseEvent *me)
+{
+    me->ignore();
+}
+
+void LeafbarTaskItem::mouseMoveEvent(TQMouseEvent *me)
+{
+    me->ignore();
+}
+
+void LeafbarTaskItem::enterEvent(TQEvent *)
+{
+}
+
+void LeafbarTaskItem::leaveEvent(TQEvent *)
+{
+}
+
+void LeafbarTaskItem::contextMenuEvent(TQContextMenuEvent *cme)
+{
+    cme->ignore();
+}
+
+/* kate: replace-tabs true; tab-width 4; */
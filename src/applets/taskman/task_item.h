@@ -0,0 +1,104 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+#ifndef _LEAFBAR_TASK_ITEM_H
+#define _LEAFBAR_TASK_ITEM_H
+
+// TQt
+#include <tqobject.h>
+#include <tqguardedptr.h>
+#include <tqfont.h>
+#include <tqimage.h>
+#include <tqpalette.h>
+
+class TQWidget;
+class TQPainter;
+class TQEvent;
+class TQMouseEvent;
+class TQContextMenuEvent;
+class LeafbarTaskContainer;
+class LeafbarTaskButton;
+
+/* A grouper or task in the task list. Items are plain records which know how
+   they look and how they react to input; they are painted by
+   LeafbarTaskButton::draw(), either into a LeafbarTaskButton of their own or
+   by LeafbarTaskView, which then passes them its input events as well. */
+class LeafbarTaskItem : public TQObject
+{
+  TQ_OBJECT
+
+  public:
+    LeafbarTaskItem(TQObject *parent);
+    virtual ~LeafbarTaskItem();
+
+    virtual LeafbarTaskContainer *container() const = 0;
+
+    // Only used in the classic layout, see LeafbarTaskContainer::createBox()
+    LeafbarTaskButton *button() const { return m_button; }
+    void createButton(TQWidget *parent);
+    void releaseButton();
+
+    virtual TQString name() = 0;
+    virtual TQImage icon() = 0;
+    virtual TQString iconCacheKey();
+    virtual bool isOn() const = 0;
+
+    virtual bool showFrame() const;
+    virtual bool showIcon() const;
+    virtual bool useBigIcon() const;
+    virtual TQFont font();
+    virtual TQColorGroup colors();
+
+    TQSize iconSize() const;
+    TQPoint iconOffset() const;
+    int height() const;
+
+    virtual void mousePressEvent(TQMouseEvent *);
+    virtual void mouseReleaseEvent(TQMouseEvent *);
+    virtual void mouseDoubleClickEvent(TQMouseEvent *);
+    virtual void mouseMoveEvent(TQMouseEvent *);
+    virtual void enterEvent(TQEvent *);
+    virtual void leaveEvent(TQEvent *);
+    virtual void contextMenuEvent(TQContextMenuEvent *);
+
+  public slots:
+    void update();
+    void scheduleRepaint();
+
+  protected:
+    // Painted over the item by LeafbarTaskButton::draw(), r is the item
+    virtual void drawOverlay(TQPainter *p, const TQRect &r);
+
+  private:
+    TQGuardedPtr<LeafbarTaskButton> m_button;
+
+    // Last elided label, reused as long as text, font and space stay the same
+    TQString m_elideText, m_elided;
+    TQFont m_elideFont;
+    int m_elideWidth;
+    TQString m_paintedIconKey;
+    TQString m_atlasKey;
+
+    bool labelChanged();
+
+  friend class LeafbarTaskButton;
+};
+
+#endif // _LEAFBAR_TASK_ITEM_H
+
+/* kate: replace-tabs true; tab-width 2; */
@@ -18,29 +18,50 @@
 
 // TQt
 #include <tqlayout.h>
+#include <tqvbox.h>
 #include <tqwhatsthis.h>
 #include <tqtimer.h>
 
 // TDE
 #include <tdeapplication.h>
+#include <tdeglobal.h>
 #include <twinmodule.h>
 #include <twin.h>
 #include <tdelocale.h>
+#include <kipc.h>
 #include <kdebug.h>
 
 // Leafbar
 #include "task.h"
 #include "task_container.h"
 #include "task_manager_cfg.h"
+#include "task_service_index.h"
+#include "task_icon_atlas.h"
+#include "task_view.h"
+#include "utils.h"
 #include "task_manager.h"
 #include "task_manager.moc"
 
-// X11
-#include <X11/Xutil.h>
-
 // NetWM
 #include <netwm.h>
 
+static const uint statAddWindow = LeafbarAppletStats::key("addWindow");
+static const uint statRemoveWindow = LeafbarAppletStats::key("removeWindow");
+static const uint statUpdateWindow = LeafbarAppletStats::key("updateWindow");
+static const uint statRelayout = LeafbarAppletStats::key("relayout");
+static const uint statContainersMoved = LeafbarAppletStats::key("containersMoved");
+static const uint statTitleUpdatesDeferred = LeafbarAppletStats::key("titleUpdatesDeferred");
+static const uint statTasks = LeafbarAppletStats::key("tasks");
+static const uint statTaskWidgets = LeafbarAppletStats::key("taskWidgets");
+static const uint statContainers = LeafbarAppletStats::key("containers");
+static const uint statServiceIndexBytes = LeafbarAppletStats::key("serviceIndexBytes");
+static const uint statClassMemoBytes = LeafbarAppletStats::key("classMemoBytes");
+static const uint statIconAtlasIcons = LeafbarAppletStats::key("iconAtlasIcons");
+static const uint statIconAtlasPages = LeafbarAppletStats::key("iconAtlasPages");
+static const uint statIconAtlasPixmapBytes = LeafbarAppletStats::key("iconAtlasPixmapBytes");
+static const uint statIconAtlasImageBytes = LeafbarAppletStats::key("iconAtlasImageBytes");
+static const uint statIconAtlasUploads = LeafbarAppletStats::key("iconAtlasUploads");
+
 extern "C"
 {
     TDE_EXPORT LeafbarApplet *init(LeafbarPanel *parent, TDEConfig *cfg)
@@ -55,12 +76,25 @@ extern "C"
 }
 
 LeafbarTaskMan::LeafbarTaskMan(LeafbarPanel *panel, TDEConfig *cfg)
-  : LeafbarApplet(panel, cfg, "LeafbarTaskMan")
+  : LeafbarApplet(panel, cfg, "LeafbarTaskMan"),
+    m_sortOrder(SortFirstSeen),
+    m_containerSerial(0),
+    m_activeTask(nullptr),
+    m_view(nullptr),
+    m_currentDesktop(0),
+    m_populating(false),
+    m_grouperStateDirty(false),
+    m_pinnedDirty(false)
 {
     m_tasks.setAutoDelete(true);
     m_containers.setAutoDelete(true);
 
-    m_twin = new KWinModule(this);
+    m_model = panelExt->windowModel();
+    m_twin = m_model->twin();
+    m_currentDesktop = m_twin->currentDesktop();
+
+    tdeApp->addKipcEventMask(KIPC::IconChanged);
+    connect(tdeApp, TQ_SIGNAL(iconChanged(int)), TQ_SLOT(slotIconChanged()));
 
     setSizePolicy(TQSizePolicy::MinimumExpanding, TQSizePolicy::Fixed);
     new TQVBoxLayout(this);
@@ -69,6 +103,16 @@ LeafbarTaskMan::LeafbarTaskMan(LeafbarPanel *panel, TDEConfig *cfg)
                                 "windows, common window operations and pinned "
                                 "applications."));
 
+    // Changes to the saved state are written in batches, see saveState()
+    m_saveTimer = new TQTimer(this);
+    connect(m_saveTimer, TQ_SIGNAL(timeout()), TQ_SLOT(saveState()));
+    connect(tdeApp, TQ_SIGNAL(shutDown()), TQ_SLOT(saveState()));
+
+    m_titleTimer = new TQTimer(this);
+    connect(m_titleTimer, TQ_SIGNAL(timeout()), TQ_SLOT(updateTitles()));
+
+    loadGrouperState();
+
     // Create containers for pinned applications
     config()->setGroup("TaskMan");
     TQStringList pinned = config()->readListEntry("Pinned");
@@ -94,25 +138,25 @@ LeafbarTaskMan::LeafbarTaskMan(LeafbarPanel *panel, TDEConfig *cfg)
     reconfigure();
 
     // Add windows
-    WIdList windows(m_twin->windows());
-    for (WIdList::ConstIterator it = windows.begin(); it != windows.end(); ++it) {
-        addWindow((*it));
-    }
+    populate();
+
+    connect(m_model, TQ_SIGNAL(windowAdded(WId)),
+                     TQ_SLOT(addWindow(WId)));
 
-    connect(m_twin, TQ_SIGNAL(windowAdded(WId)),
-                    TQ_SLOT(addWindow(WId)));
+    connect(m_model, TQ_SIGNAL(windowRemoved(WId)),
+                     TQ_SLOT(removeWindow(WId)));
 
-    connect(m_twin, TQ_SIGNAL(windowRemoved(WId)),
-                    TQ_SLOT(removeWindow(WId)));
+    connect(m_model, TQ_SIGNAL(windowChanged(WId, unsigned int, unsigned int)),
+                     TQ_SLOT(updateWindow(WId, unsigned int)));
 
-    connect(m_twin, TQ_SIGNAL(windowChanged(WId, unsigned int)),
-                    TQ_SLOT(updateWindow(WId, unsigned int)));
+    connect(m_model, TQ_SIGNAL(iconReady(WId)),
+                     TQ_SLOT(slotIconReady(WId)));
 
     connect(m_twin, TQ_SIGNAL(activeWindowChanged(WId)),
-                    TQ_SIGNAL(windowActivated(WId)));
+                    TQ_SLOT(slotActiveWindowChanged(WId)));
 
     connect(m_twin, TQ_SIGNAL(currentDesktopChanged(int)),
-                    TQ_SLOT(updateTaskVisibility()));
+                    TQ_SLOT(slotCurrentDesktopChanged(int)));
 
     connect(m_twin, TQ_SIGNAL(currentDesktopViewportChanged(int, const TQPoint&)),
                     TQ_SLOT(updateTaskVisibility()));
@@ -120,6 +164,7 @@ LeafbarTaskMan::LeafbarTaskMan(LeafbarPanel *panel, TDEConfig *cfg)
 
 LeafbarTaskMan::~LeafbarTaskMan()
 {
+    saveState();
 }
 
 void LeafbarTaskMan::reconfigure()
@@ -131,27 +176,78 @@ void LeafbarTaskMan::reconfigure()
     m_showAllDesktops = config()->readBoolEntry("ShowTasksFromAllDesktops", true);
     m_showDesktopNumber = config()->readBoolEntry("ShowDesktopNumber", false);
     m_bigGrouperIcons = config()->readBoolEntry("BigGrouperIcons", true);
+    m_maxTitleRate = kMax(1, config()->readNumEntry("MaxTitleRefreshRate", 4));
+    setSingleWidgetView(config()->readBoolEntry("SingleWidgetView", false));
 
-    TQTimer::singleShot(0, this, TQ_SLOT(updateTaskVisibility()));
+    int order = config()->readNumEntry("SortOrder", SortFirstSeen);
+    setSortOrder((order >= 0 && order < SORTORDER_MAX) ? (SortOrder)order : SortFirstSeen);
+
+    deferredCalls->call(this, TQ_SLOT(updateTaskVisibility()));
+}
+
+/* Add all the windows that already exist at startup. The properties of all
+   of them are requested from the window model in one batch, which costs a
+   single round trip; painting is held off and containers are not updated
+   until all the containers are built. Each container then resolves its
+   service and name once, and the task list is laid out once. */
+void LeafbarTaskMan::populate()
+{
+    setUpdatesEnabled(false);
+    m_populating = true;
+
+    WIdList windows(m_twin->windows());
+    m_model->prefetch(windows);
+
+    for (WIdList::ConstIterator it = windows.begin(); it != windows.end(); ++it)
+    {
+        if (m_tasks[(*it)] != nullptr) continue;
+
+        const LeafbarWindowInfo *info = m_model->info((*it));
+        if (acceptWindow(info))
+        {
+            addTask((*it), info);
+        }
+    }
+
+    m_populating = false;
+
+    // Containers may remove themselves when updated
+    TQValueList<LeafbarTaskContainer *> containers = m_order;
+    TQValueList<LeafbarTaskContainer *>::ConstIterator cit;
+    for (cit = containers.begin(); cit != containers.end(); ++cit)
+    {
+        (*cit)->update();
+    }
+
+    setUpdatesEnabled(true);
+    relayout();
+}
+
+bool LeafbarTaskMan::acceptWindow(const LeafbarWindowInfo *info)
+{
+    if (!info || !info->valid()) return false;
+
+    NET::WindowType type = info->windowType();
+    return (type == NET::Normal || type == NET::Dialog || type == NET::Utility ||
+            type == NET::Unknown || type == NET::Override) &&
+           (info->state() & NET::SkipTaskbar) == 0;
 }
 
 void LeafbarTaskMan::addWindow(WId w)
 {
     if (m_tasks[w] != nullptr) return;
+    LeafbarStatsTimer timer(stats(), statAddWindow);
 
-    KWin::WindowInfo info = KWin::windowInfo(w);
-    NET::WindowType type = info.windowType(NET::NormalMask | NET::DockMask |
-                                           NET::DesktopMask | NET::ToolbarMask |
-                                           NET::OverrideMask | NET::DialogMask |
-                                           NET::MenuMask | NET::TopMenuMask |
-                                           NET::UtilityMask | NET::SplashMask);
-
-    if ((type != NET::Normal && type != NET::Dialog && type != NET::Utility &&
-         type != NET::Unknown && type != NET::Override) ||
-        (info.state() & NET::SkipTaskbar) != 0) return;
+    const LeafbarWindowInfo *info = m_model->info(w);
+    if (acceptWindow(info))
+    {
+        addTask(w, info);
+    }
+}
 
-    TQString windowClass = className(w);
-    TQString appClass = classClass(w);
+void LeafbarTaskMan::addTask(WId w, const LeafbarWindowInfo *info)
+{
+    TQString windowClass(info->resourceName()), appClass(info->resourceClass());
 
     if (appClass.isNull()) appClass = windowClass;
     if (appClass.isNull()) return;
@@ -162,13 +258,20 @@ void LeafbarTaskMan::addWindow(WId w)
         c = new LeafbarTaskContainer(this, windowClass, appClass);
         addContainer(c);
     }
-    LeafbarTask *t = new LeafbarTask(c, w);
+    LeafbarTask *t = new LeafbarTask(c, w, info);
     m_tasks.insert(w, t);
-    c->update();
+    m_desktopTasks[t->desktop()].append(t);
+
+    // Windows of the same application often come in bursts, such as on
+    // session restore; their container is updated once for all of them.
+    if (!m_populating)
+    {
+        deferredCalls->call(c, TQ_SLOT(update()));
+    }
 
     if (w == m_twin->activeWindow())
     {
-        emit windowActivated(w);
+        slotActiveWindowChanged(w);
     }
 }
 
@@ -176,22 +279,37 @@ void LeafbarTaskMan::removeWindow(WId w)
 {
     LeafbarTask *t = m_tasks[w];
     if (!t) return;
+    LeafbarStatsTimer timer(stats(), statRemoveWindow);
+
+    if (t == m_activeTask)
+    {
+        t->container()->setActiveTask(nullptr);
+        m_activeTask = nullptr;
+    }
 
-    LeafbarTaskContainer *c = t->container();
+    m_desktopTasks[t->desktop()].remove(t);
+    m_pendingTitles.remove(t);
     m_tasks.remove(w);
+
+    if (m_view)
+    {
+        deferredCalls->call(this, TQ_SLOT(relayout()));
+    }
 }
 
 void LeafbarTaskMan::addContainer(LeafbarTaskContainer *c)
 {
     if (!c) return;
+    c->setSerial(++m_containerSerial);
     m_containers.insert(c->applicationClass(), c);
     connect(c, TQ_SIGNAL(pinChanged(bool)), TQ_SLOT(slotPinChanged(bool)));
-    layout()->add(c);
+    placeContainer(c);
 }
 
 void LeafbarTaskMan::removeContainer(LeafbarTaskContainer *c)
 {
     if (!c) return;
+    m_order.remove(c);
     m_containers.remove(c->applicationClass());
     relayout();
 }
@@ -206,54 +324,357 @@ void LeafbarTaskMan::updateTaskVisibility()
     relayout();
 }
 
+/* Only the tasks of the desktops we leave and enter can change visibility;
+   tasks on all desktops stay as they are. */
+void LeafbarTaskMan::slotCurrentDesktopChanged(int desktop)
+{
+    int previous = m_currentDesktop;
+    m_currentDesktop = desktop;
+
+    if (showAllDesktops() || previous == desktop) return;
+
+    updateDesktopVisibility(previous);
+    updateDesktopVisibility(desktop);
+    deferredCalls->call(this, TQ_SLOT(relayout()));
+}
+
+void LeafbarTaskMan::updateDesktopVisibility(int desktop)
+{
+    if (!m_desktopTasks.contains(desktop)) return;
+
+    const TaskList &tasks = m_desktopTasks[desktop];
+    TaskList::ConstIterator it;
+    for (it = tasks.begin(); it != tasks.end(); ++it)
+    {
+        (*it)->updateVisibility();
+
+        // The grouper arrow depends on the number of tasks on this desktop
+        (*it)->container()->grouper()->scheduleRepaint();
+    }
+}
+
+/* Containers are kept in order as they change (see placeContainer()), so
+   there is only the single widget view left to lay out. */
 void LeafbarTaskMan::relayout()
 {
-    TQDictIterator<LeafbarTaskContainer> it(m_containers);
+    LeafbarStatsTimer timer(stats(), statRelayout);
 
-    // Move non-pinned applications after pinned ones
-    for (; it.current(); ++it)
+    if (m_view)
+    {
+        m_view->relayout();
+    }
+}
+
+/* Pinned applications first, then by the selected sort order. Containers
+   that compare equal stay in the order they were first seen. */
+bool LeafbarTaskMan::lessThan(LeafbarTaskContainer *a, LeafbarTaskContainer *b) const
+{
+    if (a->isPinned() != b->isPinned())
+    {
+        return a->isPinned();
+    }
+
+    switch (m_sortOrder)
+    {
+        case SortName:
+        {
+            int cmp = a->application().lower().localeAwareCompare(
+                          b->application().lower());
+            if (cmp != 0) return cmp < 0;
+            break;
+        }
+
+        case SortDesktop:
+            if (a->desktop() != b->desktop())
+            {
+                return a->desktop() < b->desktop();
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return a->serial() < b->serial();
+}
+
+/* Moves a new or changed container to its place in the order. Nothing
+   happens if it is still in order with its neighbours, otherwise it is taken
+   out and inserted again at its new place. */
+void LeafbarTaskMan::placeContainer(LeafbarTaskContainer *c)
+{
+    // Not added yet, addContainer() places it
+    if (!c->serial()) return;
+
+    TQValueList<LeafbarTaskContainer *>::Iterator it = m_order.find(c);
+    if (it != m_order.end())
+    {
+        TQValueList<LeafbarTaskContainer *>::Iterator prev = it, next = it;
+        ++next;
+
+        bool inOrder = (next == m_order.end() || !lessThan(*next, c));
+        if (it != m_order.begin())
+        {
+            --prev;
+            inOrder = inOrder && !lessThan(c, *prev);
+        }
+        if (inOrder) return;
+
+        m_order.remove(it);
+    }
+
+    int index = 0;
+    for (it = m_order.begin(); it != m_order.end() && !lessThan(c, *it); ++it)
+    {
+        ++index;
+    }
+    m_order.insert(it, c);
+    stats()->count(statContainersMoved);
+
+    if (m_view)
+    {
+        deferredCalls->call(this, TQ_SLOT(relayout()));
+    }
+    else
+    {
+        TQBoxLayout *box = static_cast<TQBoxLayout *>(layout());
+        box->remove(c->box());
+        box->insertWidget(index, c->box());
+    }
+}
+
+void LeafbarTaskMan::setSortOrder(SortOrder order)
+{
+    if (order == m_sortOrder) return;
+    m_sortOrder = order;
+
+    // Place everything anew, one ordered insert at a time
+    TQValueList<LeafbarTaskContainer *> containers = m_order;
+    m_order.clear();
+
+    TQValueList<LeafbarTaskContainer *>::ConstIterator it;
+    for (it = containers.begin(); it != containers.end(); ++it)
+    {
+        placeContainer(*it);
+    }
+}
+
+/* In single widget mode the containers have no widgets at all and
+   LeafbarTaskView lays out, paints and handles input for all of them. */
+void LeafbarTaskMan::setSingleWidgetView(bool enable)
+{
+    if (enable == (m_view != nullptr)) return;
+
+    if (enable)
+    {
+        m_view = new LeafbarTaskView(this);
+    }
+    else
+    {
+        ZAP(m_view)
+    }
+
+    TQValueList<LeafbarTaskContainer *>::ConstIterator it;
+    for (it = m_order.begin(); it != m_order.end(); ++it)
+    {
+        if (enable)
+        {
+            (*it)->deleteBox();
+        }
+        else
+        {
+            (*it)->createBox();
+            layout()->add((*it)->box());
+        }
+    }
+
+    if (m_view)
     {
-      if (!it.current()->isPinned())
-      {
-          layout()->remove(it.current());
-          layout()->add(it.current());
-      }
+        layout()->add(m_view);
+        m_view->show();
     }
+    relayout();
 }
 
 void LeafbarTaskMan::updateWindow(WId w, uint changes)
 {
-    if (!changes) return;
+    if (!(changes & (TASK_INFO_PROPERTIES | NET::WMIcon))) return;
 
     LeafbarTask *t = m_tasks[w];
     if (!t) return;
+    LeafbarStatsTimer timer(stats(), statUpdateWindow);
 
-    if (changes & NET::WMState)
+    // A title change alone is applied at most maxTitleRate() times a second
+    // per window; the latest title is fetched when the wait is over.
+    unsigned long relevant = changes & (TASK_INFO_PROPERTIES | NET::WMIcon);
+    if (relevant && (relevant & ~TASK_TITLE_PROPERTIES) == 0)
     {
-        NETWinInfo info (tqt_xdisplay(),  w, tqt_xrootwin(), NET::WMState | NET::XAWMState);
+        ulong interval = 1000 / maxTitleRate();
+        if (LeafbarAppletStats::now() - t->titleTime() < interval * 1000)
+        {
+            if (!m_pendingTitles.contains(t))
+            {
+                m_pendingTitles.append(t);
+            }
+            if (!m_titleTimer->isActive())
+            {
+                m_titleTimer->start(interval, true);
+            }
+            stats()->count(statTitleUpdatesDeferred);
+            return;
+        }
+    }
+    // A deferred title goes along with whatever else changed now
+    if (m_pendingTitles.remove(t) > 0)
+    {
+        changes |= TASK_TITLE_PROPERTIES;
+    }
+
+    int oldDesktop = t->desktop();
+    t->updateInfo(changes);
+    if (t->desktop() != oldDesktop)
+    {
+        m_desktopTasks[oldDesktop].remove(t);
+        m_desktopTasks[t->desktop()].append(t);
+    }
 
-        if (info.state() & NET::SkipTaskbar)
+    if (changes & NET::WMState)
+    {
+        if (t->skipsTaskbar())
         {
             removeWindow(w);
-        }
-        else {
-            addWindow(w);
+            return;
         }
     }
 
-    if (changes & NET::WMVisibleName || changes & NET::WMName || changes & NET::WMIcon)
+    if (changes & (NET::WMVisibleName | NET::WMName | NET::WMIcon |
+                   NET::WMState | NET::XAWMState))
     {
         t->update();
     }
 
     if (changes & NET::WMDesktop)
     {
-        t->container()->updateTaskVisibility();
-        relayout();
+        t->updateVisibility();
+        t->container()->grouper()->scheduleRepaint();
+        if (sortOrder() == SortDesktop)
+        {
+            placeContainer(t->container());
+        }
+        deferredCalls->call(this, TQ_SLOT(relayout()));
+    }
+}
+
+void LeafbarTaskMan::updateTitles()
+{
+    TaskList pending = m_pendingTitles;
+    m_pendingTitles.clear();
+
+    TaskList::ConstIterator it;
+    for (it = pending.begin(); it != pending.end(); ++it)
+    {
+        (*it)->updateInfo(TASK_TITLE_PROPERTIES);
+        (*it)->update();
+    }
+}
+
+/* Only the tasks losing and gaining focus and their containers are updated,
+   however many windows there are. */
+void LeafbarTaskMan::slotActiveWindowChanged(WId w)
+{
+    LeafbarTask *t = m_tasks[w];
+    if (t == m_activeTask) return;
+
+    if (m_activeTask)
+    {
+        m_activeTask->setOn(false);
+        if (!t || t->container() != m_activeTask->container())
+        {
+            m_activeTask->container()->setActiveTask(nullptr);
+        }
+    }
+
+    m_activeTask = t;
+    if (t)
+    {
+        t->container()->setActiveTask(t);
+    }
+
+    if (m_view)
+    {
+        deferredCalls->call(m_view, TQ_SLOT(update()));
     }
 }
 
+void LeafbarTaskMan::loadGrouperState()
+{
+    m_grouperState.clear();
+
+    TQMap<TQString, TQString> entries = config()->entryMap("TaskGroupers");
+    config()->setGroup("TaskGroupers");
+    TQMap<TQString, TQString>::ConstIterator it;
+    for (it = entries.begin(); it != entries.end(); ++it)
+    {
+        m_grouperState.insert(it.key(), config()->readBoolEntry(it.key()));
+    }
+}
+
+bool LeafbarTaskMan::grouperAutoExpand(const TQString &appClass)
+{
+    TQMap<TQString, bool>::ConstIterator it = m_grouperState.find(appClass);
+    if (it == m_grouperState.end())
+    {
+        return defaultExpandGroupers();
+    }
+    return it.data();
+}
+
+void LeafbarTaskMan::setGrouperAutoExpand(const TQString &appClass, bool autoExpand)
+{
+    if (m_grouperState.contains(appClass) && m_grouperState[appClass] == autoExpand)
+    {
+        return;
+    }
+
+    m_grouperState.insert(appClass, autoExpand);
+    m_grouperStateDirty = true;
+    m_saveTimer->start(2000, true);
+}
+
 void LeafbarTaskMan::savePinnedApplications()
+{
+    m_pinnedDirty = true;
+    m_saveTimer->start(2000, true);
+}
+
+/* Writes back whatever changed since the last call. Our in-memory copy is
+   authoritative, so the state survives a reparse of the shared config. */
+void LeafbarTaskMan::saveState()
+{
+    m_saveTimer->stop();
+    if (!m_grouperStateDirty && !m_pinnedDirty) return;
+
+    if (m_grouperStateDirty)
+    {
+        config()->setGroup("TaskGroupers");
+        TQMap<TQString, bool>::ConstIterator it;
+        for (it = m_grouperState.begin(); it != m_grouperState.end(); ++it)
+        {
+            config()->writeEntry(it.key(), it.data());
+        }
+        m_grouperStateDirty = false;
+    }
+
+    if (m_pinnedDirty)
+    {
+        writePinnedApplications();
+        m_pinnedDirty = false;
+    }
+
+    config()->sync();
+}
+
+void LeafbarTaskMan::writePinnedApplications()
 {
     TQStringList pinned;
     TQDictIterator<LeafbarTaskContainer> it(m_containers);
@@ -271,41 +692,64 @@ void LeafbarTaskMan::savePinnedApplications()
     }
     config()->setGroup("TaskMan");
     config()->writeEntry("Pinned", pinned);
-    config()->sync();
 }
 
 void LeafbarTaskMan::slotPinChanged(bool pinned)
 {
     savePinnedApplications();
-    relayout();
 }
 
-TQString LeafbarTaskMan::className(WId w)
+void LeafbarTaskMan::slotIconChanged()
 {
-    XClassHint hint;
-    if (!XGetClassHint(tqt_xdisplay(), w, &hint))
+    LeafbarTaskButton::invalidateIconCache();
+
+    // Themed class icons may have come or gone with the theme
+    TQIntDictIterator<LeafbarTask> t(m_tasks);
+    for (; t.current(); ++t)
     {
-        return TQString::null;
+        t.current()->iconChanged();
     }
 
-    TQString nh(hint.res_name);
-    XFree(hint.res_name);
-    XFree(hint.res_class);
-    return nh;
+    TQDictIterator<LeafbarTaskContainer> it(m_containers);
+    for (; it.current(); ++it)
+    {
+        it.current()->reconfigure();
+    }
+}
+
+void LeafbarTaskMan::slotIconReady(WId w)
+{
+    LeafbarTask *t = m_tasks[w];
+    if (!t) return;
+
+    t->iconChanged();
+    t->update();
 }
 
-TQString LeafbarTaskMan::classClass(WId w)
+void LeafbarTaskMan::updateStats()
 {
-    XClassHint hint;
-    if (!XGetClassHint(tqt_xdisplay(), w, &hint))
+    stats()->set(statTasks, m_tasks.count());
+
+    uint widgets = 0;
+    TQIntDictIterator<LeafbarTask> it(m_tasks);
+    for (; it.current(); ++it)
     {
-        return TQString::null;
+        if (it.current()->button()) ++widgets;
     }
+    stats()->set(statTaskWidgets, widgets);
+
+    stats()->set(statContainers, m_containers.count());
+
+    LeafbarTaskServiceIndex *index = LeafbarTaskServiceIndex::instance();
+    stats()->set(statServiceIndexBytes, index->executableBytes());
+    stats()->set(statClassMemoBytes, index->classBytes());
 
-    TQString nh(hint.res_class);
-    XFree(hint.res_name);
-    XFree(hint.res_class);
-    return nh;
+    LeafbarTaskIconAtlas *atlas = LeafbarTaskIconAtlas::instance();
+    stats()->set(statIconAtlasIcons, atlas->iconCount());
+    stats()->set(statIconAtlasPages, atlas->pageCount());
+    stats()->set(statIconAtlasPixmapBytes, atlas->pixmapBytes());
+    stats()->set(statIconAtlasImageBytes, atlas->imageBytes());
+    stats()->set(statIconAtlasUploads, atlas->uploads());
 }
 
 KWinModule *LeafbarTaskMan::twin()
@@ -22,30 +22,45 @@
 // TQt
 #include <tqdict.h>
 #include <tqintdict.h>
+#include <tqvaluelist.h>
+#include <tqmap.h>
 
 // TDE
 #include <twinmodule.h>
+#include <twin.h>
 
 // Leafbar
 #include "applet.h"
 
 typedef TQValueList<WId> WIdList;
 
+class TQTimer;
+
 class LeafbarPanel;
 class LeafbarTaskContainer;
 class LeafbarTask;
+class LeafbarTaskView;
+
+typedef TQValueList<LeafbarTask *> TaskList;
 
 class LeafbarTaskMan : public LeafbarApplet {
   TQ_OBJECT
 
   public:
+    // How containers are ordered after the pinned ones
+    enum SortOrder
+    {
+      SortFirstSeen = 0,
+      SortName,
+      SortDesktop,
+      SORTORDER_MAX
+    };
+
     LeafbarTaskMan(LeafbarPanel *panel, TDEConfig *cfg);
     virtual ~LeafbarTaskMan();
 
-    static TQString className(WId w);
-    static TQString classClass(WId w);
-
     bool valid() { return true; }
+    void updateStats();
     KWinModule *twin();
 
     bool autoSaveGroupers() { return m_autoSaveGroupers; }
@@ -54,32 +69,82 @@ class LeafbarTaskMan : public LeafbarApplet {
     bool showDesktopNumber() { return m_showDesktopNumber; }
     bool bigGrouperIcons() { return m_bigGrouperIcons; }
     bool showTaskIcons() { return m_showTaskIcons; }
+    int maxTitleRate() { return m_maxTitleRate; }
+    bool populating() const { return m_populating; }
+
+    // Non-null while the task list is painted by a single widget
+    LeafbarTaskView *view() const { return m_view; }
+    void setSingleWidgetView(bool enable);
+
+    SortOrder sortOrder() const { return m_sortOrder; }
+    void setSortOrder(SortOrder order);
+
+    // Containers in the order they are laid out in
+    const TQValueList<LeafbarTaskContainer *> &orderedContainers() const { return m_order; }
+    void placeContainer(LeafbarTaskContainer *c);
+
+    bool grouperAutoExpand(const TQString &appClass);
+    void setGrouperAutoExpand(const TQString &appClass, bool autoExpand);
 
   public slots:
     void addWindow(WId w);
     void removeWindow(WId w);
     void updateWindow(WId w, unsigned int changes);
     void savePinnedApplications();
+    void saveState();
     void updateTaskVisibility();
+    void updateTitles();
     void relayout();
 
-  signals:
-    void windowActivated(WId w);
-
   private:
     TQDict<LeafbarTaskContainer> m_containers;
+    TQValueList<LeafbarTaskContainer *> m_order;
+    SortOrder m_sortOrder;
+    uint m_containerSerial;
     TQIntDict<LeafbarTask> m_tasks;
+    LeafbarTask *m_activeTask;
+
+    // Tasks by desktop (0 for all desktops), see slotCurrentDesktopChanged()
+    TQMap<int, TaskList> m_desktopTasks;
+    int m_currentDesktop;
+    bool m_populating;
+
+    // Task manager state, written back by saveState() on a timer
+    TQMap<TQString, bool> m_grouperState;
+    bool m_grouperStateDirty, m_pinnedDirty;
+    TQTimer *m_saveTimer;
+
+    // Tasks with a title change held back by the rate limit
+    TaskList m_pendingTitles;
+    TQTimer *m_titleTimer;
+
+    void loadGrouperState();
+    void writePinnedApplications();
+    LeafbarWindowModel *m_model;
     KWinModule *m_twin;
+    LeafbarTaskView *m_view;
 
     bool m_autoSaveGroupers, m_defaultExpandGroupers,
          m_showTaskIcons, m_showAllDesktops, m_showDesktopNumber,
          m_bigGrouperIcons;
+    int m_maxTitleRate;
+
+    void populate();
+    bool acceptWindow(const LeafbarWindowInfo *info);
+    void addTask(WId w, const LeafbarWindowInfo *info);
+
+    void updateDesktopVisibility(int desktop);
 
     void addContainer(LeafbarTaskContainer *c);
     void removeContainer(LeafbarTaskContainer *c);
+    bool lessThan(LeafbarTaskContainer *a, LeafbarTaskContainer *b) const;
 
   private slots:
     void slotPinChanged(bool pinned);
+    void slotActiveWindowChanged(WId w);
+    void slotCurrentDesktopChanged(int desktop);
+    void slotIconChanged();
+    void slotIconReady(WId w);
     void reconfigure();
 
   friend class LeafbarTaskContainer;
@@ -22,6 +22,10 @@
 #include <tqtabwidget.h>
 #include <tqgroupbox.h>
 #include <tqvbox.h>
+#include <tqhbox.h>
+#include <tqlabel.h>
+#include <tqspinbox.h>
+#include <tqcombobox.h>
 #include <tqwhatsthis.h>
 
 // TDE
@@ -55,27 +59,51 @@ LeafbarTaskManConfig::LeafbarTaskManConfig(TQWidget *parent, const TQString& cfg
                                               "states manually only for the applications that you want to do so "
                                               "from the context menu of its grouper"));
 
+    TQHBox *titleRateBox = new TQHBox(behaviour);
+    new TQLabel(i18n("Maximum title updates per second: "), titleRateBox);
+    m_maxTitleRate = new TQSpinBox(1, 50, 1, titleRateBox);
+    TQWhatsThis::add(m_maxTitleRate, i18n("Windows that change their title very often, for example to "
+                                          "show progress, have their task updated at most this many "
+                                          "times per second."));
+
     connect(m_defaultExpandGroupers, TQ_SIGNAL(toggled(bool)), TQ_SIGNAL(changed()));
     connect(m_autoSaveGroupers, TQ_SIGNAL(toggled(bool)), TQ_SIGNAL(changed()));
+    connect(m_maxTitleRate, TQ_SIGNAL(valueChanged(int)), TQ_SIGNAL(changed()));
 
     // Appearance
     TQVBox *appearance = new TQVBox(m_tabs);
     appearance->setMargin(KDialogBase::marginHint());
 
-    TQGroupBox *appearanceGroupers = new TQGroupBox(1, TQt::Vertical, i18n("Groupers"), appearance);
+    TQGroupBox *appearanceGroupers = new TQGroupBox(2, TQt::Vertical, i18n("Groupers"), appearance);
 
     m_bigGrouperIcons = new TQCheckBox(i18n("Use big icons in groupers"), appearanceGroupers);
 
+    TQHBox *sortOrderBox = new TQHBox(appearanceGroupers);
+    new TQLabel(i18n("Sort applications by: "), sortOrderBox);
+    m_sortOrder = new TQComboBox(false, sortOrderBox);
+    m_sortOrder->insertItem(i18n("Order of appearance"));
+    m_sortOrder->insertItem(i18n("Name"));
+    m_sortOrder->insertItem(i18n("Desktop"));
+    TQWhatsThis::add(m_sortOrder, i18n("The order of the applications in the task list. Pinned "
+                                       "applications always come first."));
+
     TQGroupBox *appearanceTasks = new TQGroupBox(3, TQt::Vertical, i18n("Tasks"), appearance);
 
     m_showAllDesktops = new TQCheckBox(i18n("Show tasks from all desktops"), appearanceTasks);
     m_showDesktopNumber = new TQCheckBox(i18n("Show desktop numbers on tasks"), appearanceTasks);
     m_showTaskIcons = new TQCheckBox(i18n("Show task icons"), appearanceTasks);
 
+    m_singleWidgetView = new TQCheckBox(i18n("Draw the task list as a single widget"), appearance);
+    TQWhatsThis::add(m_singleWidgetView, i18n("If this is checked, the whole task list is drawn by a "
+                                              "single widget instead of one widget per button. This "
+                                              "is lighter on the X server when there are many windows."));
+
     connect(m_bigGrouperIcons, TQ_SIGNAL(toggled(bool)), TQ_SIGNAL(changed()));
+    connect(m_sortOrder, TQ_SIGNAL(activated(int)), TQ_SIGNAL(changed()));
     connect(m_showAllDesktops, TQ_SIGNAL(toggled(bool)), TQ_SIGNAL(changed()));
     connect(m_showDesktopNumber, TQ_SIGNAL(toggled(bool)), TQ_SIGNAL(changed()));
     connect(m_showTaskIcons, TQ_SIGNAL(toggled(bool)), TQ_SIGNAL(changed()));
+    connect(m_singleWidgetView, TQ_SIGNAL(toggled(bool)), TQ_SIGNAL(changed()));
 
     m_tabs->addTab(behaviour, i18n("Behaviour"));
     m_tabs->addTab(appearance, i18n("Appearance"));
@@ -90,10 +118,13 @@ void LeafbarTaskManConfig::reset()
     // Behaviour
     m_defaultExpandGroupers->setChecked(true);
     m_autoSaveGroupers->setChecked(false);
+    m_maxTitleRate->setValue(4);
 
     // Appearance
     m_bigGrouperIcons->setChecked(true);
+    m_sortOrder->setCurrentItem(0);
     m_showTaskIcons->setChecked(true);
+    m_singleWidgetView->setChecked(false);
 
     // Desktops
     m_showAllDesktops->setChecked(true);
@@ -108,12 +139,15 @@ void LeafbarTaskManConfig::load()
     // Behaviour
     m_defaultExpandGroupers->setChecked(cfg->readBoolEntry("DefaultExpandGroupers", true));
     m_autoSaveGroupers->setChecked(cfg->readBoolEntry("AutoSaveGroupers", false));
+    m_maxTitleRate->setValue(cfg->readNumEntry("MaxTitleRefreshRate", 4));
 
     // Appearance
     m_bigGrouperIcons->setChecked(cfg->readBoolEntry("BigGrouperIcons", true));
+    m_sortOrder->setCurrentItem(cfg->readNumEntry("SortOrder", 0));
     m_showAllDesktops->setChecked(cfg->readBoolEntry("ShowTasksFromAllDesktops", true));
     m_showDesktopNumber->setChecked(cfg->readBoolEntry("ShowDesktopNumber", false));
     m_showTaskIcons->setChecked(cfg->readBoolEntry("ShowTaskIcons", true));
+    m_singleWidgetView->setChecked(cfg->readBoolEntry("SingleWidgetView", false));
 }
 
 void LeafbarTaskManConfig::save()
@@ -124,12 +158,15 @@ void LeafbarTaskManConfig::save()
     // Behaviour
     cfg->writeEntry("DefaultExpandGroupers", m_defaultExpandGroupers->isChecked());
     cfg->writeEntry("AutoSaveGroupers", m_autoSaveGroupers->isChecked());
+    cfg->writeEntry("MaxTitleRefreshRate", m_maxTitleRate->value());
 
     // Appearance
     cfg->writeEntry("BigGrouperIcons", m_bigGrouperIcons->isChecked());
+    cfg->writeEntry("SortOrder", m_sortOrder->currentItem());
     cfg->writeEntry("ShowTasksFromAllDesktops", m_showAllDesktops->isChecked());
     cfg->writeEntry("ShowDesktopNumber", m_showDesktopNumber->isChecked());
     cfg->writeEntry("ShowTaskIcons", m_showTaskIcons->isChecked());
+    cfg->writeEntry("SingleWidgetView", m_singleWidgetView->isChecked());
 
     cfg->sync();
 }
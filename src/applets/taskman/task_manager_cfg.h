@@ -24,6 +24,8 @@
 
 class TQTabWidget;
 class TQCheckBox;
+class TQSpinBox;
+class TQComboBox;
 class TDEConfig;
 
 class LeafbarTaskManConfig : public LeafbarAppletConfig
@@ -43,7 +45,10 @@ class LeafbarTaskManConfig : public LeafbarAppletConfig
         TQTabWidget *m_tabs;
         TQCheckBox *m_autoSaveGroupers, *m_defaultExpandGroupers,
                    *m_showTaskIcons, *m_bigGrouperIcons,
-                   *m_showAllDesktops, *m_showDesktopNumber;
+                   *m_showAllDesktops, *m_showDesktopNumber,
+                   *m_singleWidgetView;
+        TQSpinBox *m_maxTitleRate;
+        TQComboBox *m_sortOrder;
 };
 
 #endif // _LEAFBAR_TASK_MANAGER_CFG_H
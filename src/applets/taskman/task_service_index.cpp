@@ -0,0 +1,202 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+// TDE
+#include <tdeconfig.h>
+#include <ksycoca.h>
+#include <kdebug.h>
+
+// Leafbar
+#include "deferred_calls.h"
+#include "task_service_index.h"
+#include "task_service_index.moc"
+
+static LeafbarTaskServiceIndex *leafbarTaskServiceIndex = nullptr;
+LeafbarTaskServiceIndex *LeafbarTaskServiceIndex::instance() {
+    if (!leafbarTaskServiceIndex) {
+        leafbarTaskServiceIndex = new LeafbarTaskServiceIndex();
+    }
+    return leafbarTaskServiceIndex;
+}
+
+LeafbarTaskServiceIndex::LeafbarTaskServiceIndex()
+: TQObject(),
+  m_valid(false)
+{
+    m_cache = new TDEConfig("leafbartaskservices", false, false, "cache");
+    loadClasses();
+
+    connect(KSycoca::self(), TQ_SIGNAL(databaseChanged()), TQ_SLOT(invalidate()));
+}
+
+LeafbarTaskServiceIndex::~LeafbarTaskServiceIndex()
+{
+    delete m_cache;
+}
+
+void LeafbarTaskServiceIndex::invalidate()
+{
+    // Rebuilt on the next lookup, so that a burst of changes costs one scan
+    m_valid = false;
+    m_exec.clear();
+
+    m_classes.clear();
+    m_usedClasses.clear();
+    deferredCalls->call(this, TQ_SLOT(saveClasses()));
+}
+
+void LeafbarTaskServiceIndex::loadClasses()
+{
+    // Results are only good for the database they were obtained from, so
+    // those of another one are dropped from the file as well
+    m_cache->setGroup("General");
+    if (m_cache->readUnsignedNumEntry("SycocaTimeStamp") != KSycoca::self()->timeStamp())
+    {
+        m_cache->deleteGroup("Classes");
+        m_cache->sync();
+        return;
+    }
+
+    m_classes = m_cache->entryMap("Classes");
+}
+
+/* Classes of windows not seen in this session are the first to go once there
+   are more than CLASS_MEMO_MAX of them. */
+void LeafbarTaskServiceIndex::saveClasses()
+{
+    TQMap<TQString, TQString>::Iterator cit = m_classes.begin();
+    while (m_classes.count() > CLASS_MEMO_MAX && cit != m_classes.end())
+    {
+        TQMap<TQString, TQString>::Iterator gone = cit++;
+        if (!m_usedClasses.contains(gone.key()))
+        {
+            m_classes.remove(gone);
+        }
+    }
+
+    m_cache->deleteGroup("Classes");
+    m_cache->setGroup("Classes");
+    TQMap<TQString, TQString>::ConstIterator it;
+    for (it = m_classes.begin(); it != m_classes.end(); ++it)
+    {
+        m_cache->writeEntry(it.key(), it.data());
+    }
+
+    m_cache->setGroup("General");
+    m_cache->writeEntry("SycocaTimeStamp", KSycoca::self()->timeStamp());
+    m_cache->sync();
+}
+
+TQString LeafbarTaskServiceIndex::classKey(const TQString &resClass,
+                                          const TQString &resName,
+                                          const TQString &exePath)
+{
+    return TQString("%1/%2/%3").arg(resClass).arg(resName).arg(exePath);
+}
+
+/* Returns true if the class has been resolved before, in which case service
+   is set to the result (which may be null if no service was found). */
+bool LeafbarTaskServiceIndex::lookupClass(const TQString &key, KService::Ptr *service)
+{
+    TQMap<TQString, TQString>::ConstIterator it = m_classes.find(key);
+    if (it == m_classes.end()) return false;
+    m_usedClasses.insert(key, true);
+
+    if (it.data().isEmpty())
+    {
+        *service = nullptr;
+        return true;
+    }
+
+    *service = KService::serviceByStorageId(it.data());
+    return (*service) != nullptr;
+}
+
+void LeafbarTaskServiceIndex::rememberClass(const TQString &key, KService::Ptr service)
+{
+    TQString id = service ? service->storageId() : TQString("");
+    m_usedClasses.insert(key, true);
+    if (m_classes.contains(key) && m_classes[key] == id) return;
+
+    m_classes.insert(key, id);
+    deferredCalls->call(this, TQ_SLOT(saveClasses()));
+}
+
+void LeafbarTaskServiceIndex::build()
+{
+    KService::List all = KService::allServices();
+    KService::List::ConstIterator svc;
+    for (svc = all.begin(); svc != all.end(); ++svc)
+    {
+        // Get rid of any argument placeholders might be present
+        TQStringList exec = TQStringList::split(" ", (*svc)->exec());
+        if (exec.isEmpty()) continue;
+
+        // First match wins, as with a linear scan of the services
+        if (!m_exec.contains(exec[0]))
+        {
+            m_exec.insert(exec[0], (*svc));
+        }
+    }
+    m_valid = true;
+}
+
+KService::Ptr LeafbarTaskServiceIndex::findByExecutable(const TQString &path,
+                                                        const TQString &name)
+{
+    if (!m_valid) build();
+
+    TQMap<TQString, KService::Ptr>::ConstIterator it;
+    if (!path.isEmpty() && (it = m_exec.find(path)) != m_exec.end())
+    {
+        return it.data();
+    }
+
+    if (!name.isEmpty() && (it = m_exec.find(name)) != m_exec.end())
+    {
+        return it.data();
+    }
+
+    return nullptr;
+}
+
+/* Counts the characters of the keys (and values) only; the map nodes and the
+   services themselves, which KSycoca keeps anyway, are left out. */
+ulong LeafbarTaskServiceIndex::executableBytes() const
+{
+    ulong bytes = 0;
+    TQMap<TQString, KService::Ptr>::ConstIterator it;
+    for (it = m_exec.begin(); it != m_exec.end(); ++it)
+    {
+        bytes += it.key().length() * sizeof(TQChar);
+    }
+    return bytes;
+}
+
+ulong LeafbarTaskServiceIndex::classBytes() const
+{
+    ulong bytes = 0;
+    TQMap<TQString, TQString>::ConstIterator it;
+    for (it = m_classes.begin(); it != m_classes.end(); ++it)
+    {
+        bytes += (it.key().length() + it.data().length()) * sizeof(TQChar);
+    }
+    return bytes;
+}
+
+/* kate: replace-tabs true; tab-width 4; */
@@ -0,0 +1,83 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+#ifndef _LEAFBAR_TASK_SERVICE_INDEX_H
+#define _LEAFBAR_TASK_SERVICE_INDEX_H
+
+// TQt
+#include <tqobject.h>
+#include <tqmap.h>
+
+// TDE
+#include <kservice.h>
+
+class TDEConfig;
+
+// Classes remembered across sessions, beyond which those not seen in the
+// current session are forgotten (see LeafbarTaskServiceIndex::saveClasses())
+#define CLASS_MEMO_MAX 256
+
+/* Maps executable names and paths, as found at the start of the Exec line of
+   desktop files, to their services. Built on first use and rebuilt after the
+   KSycoca database changes.
+
+   Also remembers which service (if any) each window class resolved to, in a
+   cache file that is kept across sessions for as long as the KSycoca database
+   does not change, and kept from growing past CLASS_MEMO_MAX entries. */
+class LeafbarTaskServiceIndex : public TQObject {
+  TQ_OBJECT
+
+  public:
+    static LeafbarTaskServiceIndex *instance();
+
+    KService::Ptr findByExecutable(const TQString &path, const TQString &name);
+
+    // Memory taken by the strings of the executable index and class memo
+    ulong executableBytes() const;
+    ulong classBytes() const;
+
+    static TQString classKey(const TQString &resClass, const TQString &resName,
+                             const TQString &exePath);
+    bool lookupClass(const TQString &key, KService::Ptr *service);
+    void rememberClass(const TQString &key, KService::Ptr service);
+
+  private slots:
+    void invalidate();
+    void saveClasses();
+
+  private:
+    LeafbarTaskServiceIndex();
+    ~LeafbarTaskServiceIndex();
+
+    void build();
+    void loadClasses();
+
+    TQMap<TQString, KService::Ptr> m_exec;
+    bool m_valid;
+
+    // Class key -> storage id, empty if the class has no service
+    TQMap<TQString, TQString> m_classes;
+
+    // Class keys looked up or remembered in this session
+    TQMap<TQString, bool> m_usedClasses;
+    TDEConfig *m_cache;
+};
+
+#endif // _LEAFBAR_TASK_SERVICE_INDEX_H
+
+/* kate: replace-tabs true; tab-width 2; */
@@ -0,0 +1,259 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+// TQt
+#include <tqpainter.h>
+#include <tqpixmap.h>
+#include <tqtooltip.h>
+
+// Leafbar
+#include "task.h"
+#include "task_container.h"
+#include "task_button.h"
+#include "task_view.h"
+#include "task_view.moc"
+
+class LeafbarTaskViewTip : public TQToolTip
+{
+  public:
+    LeafbarTaskViewTip(LeafbarTaskView *view)
+      : TQToolTip(view),
+        m_view(view)
+    {}
+
+  protected:
+    void maybeTip(const TQPoint &pos)
+    {
+        TQRect r;
+        LeafbarTaskItem *item = m_view->itemAt(pos, &r);
+        if (item)
+        {
+            tip(r, item->name());
+        }
+    }
+
+  private:
+    LeafbarTaskView *m_view;
+};
+
+LeafbarTaskView::LeafbarTaskView(LeafbarTaskMan *parent)
+  : TQWidget(parent, "LeafbarTaskView", WNoAutoErase),
+    m_height(0)
+{
+    setSizePolicy(TQSizePolicy::MinimumExpanding, TQSizePolicy::Fixed);
+    setMouseTracking(true);
+    m_tip = new LeafbarTaskViewTip(this);
+}
+
+LeafbarTaskView::~LeafbarTaskView()
+{
+    delete m_tip;
+}
+
+LeafbarTaskMan *LeafbarTaskView::manager() const
+{
+    return static_cast<LeafbarTaskMan *>(parent());
+}
+
+TQSize LeafbarTaskView::sizeHint() const
+{
+    return TQSize(width(), m_height);
+}
+
+void LeafbarTaskView::relayout()
+{
+    m_items.clear();
+
+    int y = 0;
+    const TQValueList<LeafbarTaskContainer *> &containers = manager()->orderedContainers();
+    TQValueList<LeafbarTaskContainer *>::ConstIterator cit;
+    for (cit = containers.begin(); cit != containers.end(); ++cit)
+    {
+        LeafbarTaskGrouper *g = (*cit)->grouper();
+
+        Item entry;
+        entry.item = g;
+        entry.rect = TQRect(0, y, width(), g->height());
+        m_items.append(entry);
+        y += entry.rect.height();
+
+        if (!g->expanded()) continue;
+
+        const TaskList &tasks = (*cit)->tasks();
+        TaskList::ConstIterator tit;
+        for (tit = tasks.begin(); tit != tasks.end(); ++tit)
+        {
+            if (!(*tit)->isShown()) continue;
+
+            entry.item = *tit;
+            entry.rect = TQRect(0, y, width(), (*tit)->height());
+            m_items.append(entry);
+            y += entry.rect.height();
+        }
+    }
+
+    if (y != m_height)
+    {
+        m_height = y;
+        updateGeometry();
+    }
+    update();
+}
+
+LeafbarTaskItem *LeafbarTaskView::itemAt(const TQPoint &pos, TQRect *rect)
+{
+    ItemList::ConstIterator it;
+    for (it = m_items.begin(); it != m_items.end(); ++it)
+    {
+        if ((*it).item && (*it).rect.contains(pos))
+        {
+            if (rect) *rect = (*it).rect;
+            return (*it).item;
+        }
+    }
+    return nullptr;
+}
+
+TQRect LeafbarTaskView::itemRect(LeafbarTaskItem *item) const
+{
+    ItemList::ConstIterator it;
+    for (it = m_items.begin(); it != m_items.end(); ++it)
+    {
+        if ((LeafbarTaskItem *)(*it).item == item) return (*it).rect;
+    }
+    return TQRect();
+}
+
+/* Sends the items the enter and leave events they would get if they were
+   shown by buttons of their own */
+void LeafbarTaskView::setHovered(LeafbarTaskItem *item)
+{
+    LeafbarTaskItem *hovered = m_hovered;
+    if (hovered == item) return;
+
+    if (hovered)
+    {
+        TQEvent e(TQEvent::Leave);
+        hovered->leaveEvent(&e);
+    }
+
+    m_hovered = item;
+    if (item)
+    {
+        TQEvent e(TQEvent::Enter);
+        item->enterEvent(&e);
+    }
+}
+
+void LeafbarTaskView::paintEvent(TQPaintEvent *e)
+{
+    TQPainter p(&m_buffer);
+    p.setClipRect(e->rect());
+    p.fillRect(e->rect(), colorGroup().brush(TQColorGroup::Background));
+
+    ItemList::ConstIterator it;
+    for (it = m_items.begin(); it != m_items.end(); ++it)
+    {
+        if (!(*it).item || !(*it).rect.intersects(e->rect())) continue;
+        LeafbarTaskButton::draw(&p, (*it).item, (*it).rect);
+    }
+    p.end();
+
+    bitBlt(this, e->rect().topLeft(), &m_buffer, e->rect());
+}
+
+void LeafbarTaskView::resizeEvent(TQResizeEvent *)
+{
+    m_buffer.resize(size());
+    relayout();
+}
+
+#define FORWARD_MOUSE_EVENT(handler) \
+    TQRect r; \
+    LeafbarTaskItem *b = itemAt(me->pos(), &r); \
+    if (!b) { me->ignore(); return; } \
+    TQMouseEvent e(me->type(), me->pos() - r.topLeft(), me->globalPos(), \
+                   me->button(), me->state()); \
+    b->handler(&e); \
+    deferredCalls->call(this, TQ_SLOT(relayout()));
+
+void LeafbarTaskView::mousePressEvent(TQMouseEvent *me)
+{
+    FORWARD_MOUSE_EVENT(mousePressEvent)
+    m_pressed = b;
+}
+
+void LeafbarTaskView::mouseDoubleClickEvent(TQMouseEvent *me)
+{
+    FORWARD_MOUSE_EVENT(mouseDoubleClickEvent)
+    m_pressed = b;
+}
+#undef FORWARD_MOUSE_EVENT
+
+/* Like TQt does for widgets, the release goes to the item that got the
+   press, wherever the cursor is by then */
+void LeafbarTaskView::mouseReleaseEvent(TQMouseEvent *me)
+{
+    LeafbarTaskItem *b = m_pressed;
+    m_pressed = nullptr;
+    if (!b) { me->ignore(); return; }
+
+    TQRect r = itemRect(b);
+    TQMouseEvent e(me->type(), me->pos() - r.topLeft(), me->globalPos(),
+                   me->button(), me->state());
+    b->mouseReleaseEvent(&e);
+    deferredCalls->call(this, TQ_SLOT(relayout()));
+}
+
+void LeafbarTaskView::mouseMoveEvent(TQMouseEvent *me)
+{
+    TQRect r;
+    LeafbarTaskItem *b = itemAt(me->pos(), &r);
+    setHovered(b);
+
+    // While a button is held down, moves go to the item pressed
+    if (m_pressed)
+    {
+        b = m_pressed;
+        r = itemRect(b);
+    }
+    if (!b) { me->ignore(); return; }
+
+    TQMouseEvent e(me->type(), me->pos() - r.topLeft(), me->globalPos(),
+                   me->button(), me->state());
+    b->mouseMoveEvent(&e);
+}
+
+void LeafbarTaskView::leaveEvent(TQEvent *)
+{
+    setHovered(nullptr);
+}
+
+void LeafbarTaskView::contextMenuEvent(TQContextMenuEvent *cme)
+{
+    TQRect r;
+    LeafbarTaskItem *b = itemAt(cme->pos(), &r);
+    if (!b) return;
+
+    TQContextMenuEvent e(cme->reason(), cme->pos() - r.topLeft(),
+                         cme->globalPos(), cme->state());
+    b->contextMenuEvent(&e);
+    deferredCalls->call(this, TQ_SLOT(relayout()));
+}
+
+/* kate: replace-tabs true; tab-width 4; */
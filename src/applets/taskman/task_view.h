@@ -0,0 +1,86 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+#ifndef _LEAFBAR_TASK_VIEW_H
+#define _LEAFBAR_TASK_VIEW_H
+
+// TQt
+#include <tqwidget.h>
+#include <tqpixmap.h>
+#include <tqguardedptr.h>
+#include <tqvaluelist.h>
+
+class LeafbarTaskMan;
+class LeafbarTaskItem;
+class LeafbarTaskViewTip;
+
+/* Paints the whole task list in a single widget. The groupers and tasks have
+   no widgets of their own in this mode: this view lays them out, paints them
+   into one buffer and forwards mouse events to the item under the cursor, as
+   well as enter and leave events when the cursor moves from one item to
+   another. */
+class LeafbarTaskView : public TQWidget {
+  TQ_OBJECT
+
+  public:
+    LeafbarTaskView(LeafbarTaskMan *parent);
+    ~LeafbarTaskView();
+
+    LeafbarTaskMan *manager() const;
+    LeafbarTaskItem *itemAt(const TQPoint &pos, TQRect *rect = nullptr);
+
+    TQSize sizeHint() const;
+
+  public slots:
+    void relayout();
+
+  protected:
+    void paintEvent(TQPaintEvent *);
+    void resizeEvent(TQResizeEvent *);
+    void mousePressEvent(TQMouseEvent *);
+    void mouseReleaseEvent(TQMouseEvent *);
+    void mouseDoubleClickEvent(TQMouseEvent *);
+    void mouseMoveEvent(TQMouseEvent *);
+    void leaveEvent(TQEvent *);
+    void contextMenuEvent(TQContextMenuEvent *);
+
+  private:
+    struct Item
+    {
+      TQGuardedPtr<LeafbarTaskItem> item;
+      TQRect rect;
+    };
+    typedef TQValueList<Item> ItemList;
+
+    ItemList m_items;
+    int m_height;
+    LeafbarTaskViewTip *m_tip;
+
+    // Kept across paints, reallocated only when the view is resized
+    TQPixmap m_buffer;
+
+    // Item the last press went to, and item under the cursor
+    TQGuardedPtr<LeafbarTaskItem> m_pressed, m_hovered;
+
+    TQRect itemRect(LeafbarTaskItem *item) const;
+    void setHovered(LeafbarTaskItem *item);
+};
+
+#endif // _LEAFBAR_TASK_VIEW_H
+
+/* kate: replace-tabs true; tab-width 2; */
@@ -0,0 +1,388 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+/* Scripted X client for benchmarking the task manager: maps, renames,
+   re-icons, moves between desktops and closes windows at a given rate, so
+   that the latency the panel reports can be compared between builds.
+   window_storm_benchmark.sh runs it against Xvfb together with twin and the
+   panel; it can also be pointed at any display with DISPLAY. */
+
+// TQt
+#include <tqstring.h>
+#include <tqstringlist.h>
+#include <tqvaluevector.h>
+
+// X11
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+
+// stdlib
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <time.h>
+#include <unistd.h>
+
+enum Operation
+{
+    Map = 0,
+    Rename,
+    Reicon,
+    Move,
+    Close,
+    OPERATION_COUNT
+};
+
+static const char *operationNames[OPERATION_COUNT] = {
+    "map", "rename", "icon", "move", "close"
+};
+
+struct WeightedClass
+{
+    TQString name;
+    int weight;
+};
+
+struct Options
+{
+    int windows;
+    int live;
+    int rate;
+    int desktops;
+    uint seed;
+    TQValueVector<WeightedClass> classes;
+    int mix[OPERATION_COUNT];
+};
+
+struct StormWindow
+{
+    Window id;
+    TQString cls;
+    uint serial;
+};
+
+static Display *dpy = nullptr;
+static Atom netWmName, netWmIcon, netWmPid, netWmDesktop, netWmWindowType,
+            netWmWindowTypeNormal, netNumberOfDesktops, utf8String;
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --windows N   windows to create over the run (default 2000)\n"
+        "  --live N      most windows open at once (default 400)\n"
+        "  --rate N      operations per second (default 500)\n"
+        "  --desktops N  desktops to spread windows over (default 4)\n"
+        "  --classes L   window classes and weights\n"
+        "                (default konsole=40,firefox=30,kate=20,xterm=10)\n"
+        "  --mix L       operation weights\n"
+        "                (default map=20,rename=40,icon=10,move=15,close=15)\n"
+        "  --seed N      random seed (default 1)\n", argv0);
+}
+
+/* Parses "name=weight,..." lists */
+static bool parseWeights(const char *arg, TQStringList &names, TQValueVector<int> &weights)
+{
+    TQStringList items = TQStringList::split(',', TQString::fromLocal8Bit(arg));
+    TQStringList::ConstIterator it;
+    for (it = items.begin(); it != items.end(); ++it)
+    {
+        bool ok;
+        int weight = (*it).section('=', 1, 1).toInt(&ok);
+        if (!ok || weight < 0) return false;
+
+        names << (*it).section('=', 0, 0);
+        weights.append(weight);
+    }
+    return !names.isEmpty();
+}
+
+static bool parseOptions(int argc, char **argv, Options &o)
+{
+    o.windows = 2000;
+    o.live = 400;
+    o.rate = 500;
+    o.desktops = 4;
+    o.seed = 1;
+
+    const char *classes = "konsole=40,firefox=30,kate=20,xterm=10";
+    const char *mix = "map=20,rename=40,icon=10,move=15,close=15";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 >= argc) return false;
+        const char *value = argv[++i];
+
+        if (!strcmp(argv[i - 1], "--windows")) o.windows = atoi(value);
+        else if (!strcmp(argv[i - 1], "--live")) o.live = atoi(value);
+        else if (!strcmp(argv[i - 1], "--rate")) o.rate = atoi(value);
+        else if (!strcmp(argv[i - 1], "--desktops")) o.desktops = atoi(value);
+        else if (!strcmp(argv[i - 1], "--seed")) o.seed = strtoul(value, nullptr, 10);
+        else if (!strcmp(argv[i - 1], "--classes")) classes = value;
+        else if (!strcmp(argv[i - 1], "--mix")) mix = value;
+        else return false;
+    }
+    if (o.windows <= 0 || o.live <= 0 || o.rate <= 0 || o.desktops <= 0) return false;
+
+    TQStringList names;
+    TQValueVector<int> weights;
+    if (!parseWeights(classes, names, weights)) return false;
+    for (uint i = 0; i < names.count(); ++i)
+    {
+        WeightedClass c;
+        c.name = names[i];
+        c.weight = weights[i];
+        o.classes.append(c);
+    }
+
+    names.clear();
+    weights.clear();
+    if (!parseWeights(mix, names, weights)) return false;
+    for (int op = 0; op < OPERATION_COUNT; ++op) o.mix[op] = 0;
+    for (uint i = 0; i < names.count(); ++i)
+    {
+        int op = 0;
+        while (op < OPERATION_COUNT && names[i] != operationNames[op]) ++op;
+        if (op == OPERATION_COUNT) return false;
+        o.mix[op] = weights[i];
+    }
+    return true;
+}
+
+static ulong now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+}
+
+static const TQString &pickClass(const Options &o)
+{
+    int total = 0;
+    for (uint i = 0; i < o.classes.count(); ++i) total += o.classes[i].weight;
+
+    int r = total > 0 ? rand() % total : 0;
+    uint i = 0;
+    while (i + 1 < o.classes.count() && r >= o.classes[i].weight)
+    {
+        r -= o.classes[i].weight;
+        ++i;
+    }
+    return o.classes[i].name;
+}
+
+static void setName(const StormWindow &w)
+{
+    TQCString title = TQString::fromUtf8("%1 — document %2, revision %3 — a long title "
+                                         "as browsers and terminals set them")
+                      .arg(w.cls).arg(w.id).arg(w.serial).utf8();
+    XChangeProperty(dpy, w.id, netWmName, utf8String, 8, PropModeReplace,
+                    (const unsigned char *)title.data(), title.length());
+}
+
+/* Sets a 16x16 and a 32x32 icon in a colour that changes with every call */
+static void setIcon(const StormWindow &w)
+{
+    ulong colour = 0xff000000 | ((w.id * 2654435761UL + w.serial * 40503UL) & 0xffffff);
+
+    // Format 32 properties are passed as longs, whatever their size
+    TQValueVector<long> data;
+    const int sizes[] = { 16, 32 };
+    for (int s = 0; s < 2; ++s)
+    {
+        data.append(sizes[s]);
+        data.append(sizes[s]);
+        for (int p = 0; p < sizes[s] * sizes[s]; ++p) data.append(colour);
+    }
+    XChangeProperty(dpy, w.id, netWmIcon, XA_CARDINAL, 32, PropModeReplace,
+                    (const unsigned char *)&data[0], data.count());
+}
+
+static StormWindow mapWindow(const Options &o, uint serial)
+{
+    StormWindow w;
+    w.cls = pickClass(o);
+    w.serial = serial;
+    w.id = XCreateSimpleWindow(dpy, DefaultRootWindow(dpy), 0, 0, 320, 200, 0,
+                               BlackPixel(dpy, DefaultScreen(dpy)),
+                               WhitePixel(dpy, DefaultScreen(dpy)));
+
+    TQCString cls = w.cls.latin1();
+    TQCString name = w.cls.lower().latin1();
+    XClassHint hint;
+    hint.res_name = name.data();
+    hint.res_class = cls.data();
+    XSetClassHint(dpy, w.id, &hint);
+
+    long pid = getpid();
+    XChangeProperty(dpy, w.id, netWmPid, XA_CARDINAL, 32, PropModeReplace,
+                    (const unsigned char *)&pid, 1);
+    long type = netWmWindowTypeNormal;
+    XChangeProperty(dpy, w.id, netWmWindowType, XA_ATOM, 32, PropModeReplace,
+                    (const unsigned char *)&type, 1);
+    XStoreName(dpy, w.id, cls.data());
+    setName(w);
+    setIcon(w);
+
+    XMapWindow(dpy, w.id);
+    return w;
+}
+
+/* Asks the window manager to move a window, as pagers do */
+static void moveWindow(const StormWindow &w, int desktop)
+{
+    XEvent e;
+    memset(&e, 0, sizeof(e));
+    e.xclient.type = ClientMessage;
+    e.xclient.window = w.id;
+    e.xclient.message_type = netWmDesktop;
+    e.xclient.format = 32;
+    e.xclient.data.l[0] = desktop;
+    e.xclient.data.l[1] = 2;
+    XSendEvent(dpy, DefaultRootWindow(dpy), False,
+               SubstructureRedirectMask | SubstructureNotifyMask, &e);
+}
+
+static void setDesktopCount(int desktops)
+{
+    XEvent e;
+    memset(&e, 0, sizeof(e));
+    e.xclient.type = ClientMessage;
+    e.xclient.window = DefaultRootWindow(dpy);
+    e.xclient.message_type = netNumberOfDesktops;
+    e.xclient.format = 32;
+    e.xclient.data.l[0] = desktops;
+    XSendEvent(dpy, DefaultRootWindow(dpy), False,
+               SubstructureRedirectMask | SubstructureNotifyMask, &e);
+}
+
+/* Picks an operation by weight among those possible right now */
+static Operation pickOperation(const Options &o, int created, int live)
+{
+    int weights[OPERATION_COUNT];
+    int total = 0;
+    for (int op = 0; op < OPERATION_COUNT; ++op)
+    {
+        bool possible = (op == Map) ? (created < o.windows && live < o.live) : (live > 0);
+        weights[op] = possible ? o.mix[op] : 0;
+        total += weights[op];
+    }
+
+    // Every window has been created and the mix closes none: close them anyway
+    if (total == 0) return live > 0 ? Close : Map;
+
+    int r = rand() % total;
+    int op = 0;
+    while (r >= weights[op])
+    {
+        r -= weights[op];
+        ++op;
+    }
+    return (Operation)op;
+}
+
+int main(int argc, char **argv)
+{
+    Options o;
+    if (!parseOptions(argc, argv, o))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    dpy = XOpenDisplay(nullptr);
+    if (!dpy)
+    {
+        fprintf(stderr, "%s: cannot open display\n", argv[0]);
+        return 1;
+    }
+
+    netWmName = XInternAtom(dpy, "_NET_WM_NAME", False);
+    netWmIcon = XInternAtom(dpy, "_NET_WM_ICON", False);
+    netWmPid = XInternAtom(dpy, "_NET_WM_PID", False);
+    netWmDesktop = XInternAtom(dpy, "_NET_WM_DESKTOP", False);
+    netWmWindowType = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE", False);
+    netWmWindowTypeNormal = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_NORMAL", False);
+    netNumberOfDesktops = XInternAtom(dpy, "_NET_NUMBER_OF_DESKTOPS", False);
+    utf8String = XInternAtom(dpy, "UTF8_STRING", False);
+
+    srand(o.seed);
+    setDesktopCount(o.desktops);
+
+    TQValueVector<StormWindow> windows;
+    ulong counts[OPERATION_COUNT] = { 0 };
+    int created = 0;
+    uint serial = 0;
+
+    const ulong interval = 1000000UL / o.rate;
+    ulong start = now(), next = start;
+    while (created < o.windows || !windows.isEmpty())
+    {
+        Operation op = pickOperation(o, created, windows.count());
+        int i = windows.isEmpty() ? 0 : rand() % windows.count();
+        ++serial;
+
+        switch (op)
+        {
+            case Map:
+                windows.append(mapWindow(o, serial));
+                ++created;
+                break;
+            case Rename:
+                windows[i].serial = serial;
+                setName(windows[i]);
+                break;
+            case Reicon:
+                windows[i].serial = serial;
+                setIcon(windows[i]);
+                break;
+            case Move:
+                moveWindow(windows[i], rand() % o.desktops);
+                break;
+            case Close:
+                XDestroyWindow(dpy, windows[i].id);
+                windows[i] = windows.back();
+                windows.pop_back();
+                break;
+            default:
+                break;
+        }
+        ++counts[op];
+        XFlush(dpy);
+
+        // Keep to the rate on average, without sleeping for tiny intervals
+        next += interval;
+        ulong t = now();
+        if (next > t + 1000) usleep(next - t);
+    }
+    XSync(dpy, False);
+
+    ulong elapsed = now() - start;
+    printf("window_storm: %d windows, %.1f s", created, elapsed / 1000000.0);
+    for (int op = 0; op < OPERATION_COUNT; ++op)
+    {
+        printf(" %s=%lu", operationNames[op], counts[op]);
+    }
+    printf("\n");
+
+    XCloseDisplay(dpy);
+    return 0;
+}
+
+/* kate: replace-tabs true; tab-width 4; */
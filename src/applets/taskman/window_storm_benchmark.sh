@@ -0,0 +1,75 @@
+#!/bin/sh
+################################################################################
+# Leafbar - a DeskBar-style panel for TDE                                      #
+# Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>     #
+#                                                                              #
+# Improvements and feedback are welcome!                                       #
+# This software is licensed under the terms of the GNU GPL v3 license.         #
+################################################################################
+
+# Runs the installed panel on a private Xvfb server with twin, storms it with
+# leafbar_window_storm and prints the task manager statistics: p50/p99 of
+# addWindow, removeWindow and updateWindow in microseconds, relayout counts
+# and the peak RSS of the panel in kB.
+#
+# usage: window_storm_benchmark.sh XVFB WINDOW_STORM [window storm options]
+#
+# Options for leafbar_window_storm are also taken from WINDOW_STORM_ARGS. The
+# display defaults to :99 (LEAFBAR_BENCHMARK_DISPLAY) and the full statistics
+# are kept in window-storm-stats.txt in the current directory.
+
+set -e
+
+XVFB="$1"
+WINDOW_STORM="$2"
+shift 2
+
+DISPLAY="${LEAFBAR_BENCHMARK_DISPLAY:-:99}"
+TDEHOME="$(mktemp -d)"
+export DISPLAY TDEHOME
+
+PIDS=""
+cleanup()
+{
+    dcop leafbar LeafbarIface quit >/dev/null 2>&1 || true
+    for pid in $PIDS; do kill "$pid" 2>/dev/null || true; done
+    rm -rf "$TDEHOME"
+}
+trap cleanup EXIT INT TERM
+
+# Waits up to 10 seconds for a command to succeed
+wait_for()
+{
+    i=0
+    until "$@" >/dev/null 2>&1; do
+        i=$((i + 1))
+        [ $i -lt 100 ] || { echo "timed out waiting for: $*" >&2; exit 1; }
+        sleep 0.1
+    done
+}
+
+"$XVFB" "$DISPLAY" -screen 0 1280x1024x24 -nolisten tcp >/dev/null 2>&1 &
+PIDS="$! $PIDS"
+wait_for xdpyinfo
+
+dcopserver --nofork --nosid >/dev/null 2>&1 &
+PIDS="$! $PIDS"
+wait_for dcop
+
+twin >/dev/null 2>&1 &
+PIDS="$! $PIDS"
+wait_for dcop twin
+
+leafbar >/dev/null 2>&1 &
+PIDS="$! $PIDS"
+wait_for dcop leafbar LeafbarIface ping
+
+"$WINDOW_STORM" "$@" $WINDOW_STORM_ARGS
+
+# Let the panel drain the events still queued before reading its statistics
+sleep 2
+dcop leafbar LeafbarIface stats > window-storm-stats.txt
+
+grep -E '^(peakMemory=|taskman\.(addWindow|removeWindow|updateWindow|relayout):)' \
+     window-storm-stats.txt |
+    sed -e 's/ total=[0-9]*//' -e 's/ max=[0-9]*//'
@@ -66,6 +66,16 @@ void LeafbarApp::reloadApplet(TQString applet)
     m_panel->reloadApplet(applet);
 }
 
+TQStringList LeafbarApp::stats()
+{
+    return m_panel->stats();
+}
+
+TQStringList LeafbarApp::appletStats(TQString applet)
+{
+    return m_panel->appletStats(applet);
+}
+
 void LeafbarApp::quit()
 {
     tdeApp->quit();
@@ -36,6 +36,8 @@ class LeafbarApp : public TDEUniqueApplication, LeafbarIface {
     bool ping();
     void reconfigure();
     void reloadApplet(TQString applet);
+    TQStringList stats();
+    TQStringList appletStats(TQString applet);
     void quit();
 
   private:
@@ -0,0 +1,134 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+// TQt
+#include <tqtimer.h>
+#include <tqsignal.h>
+#include <tqmetaobject.h>
+
+// TDE
+#include <kdebug.h>
+
+// Leafbar
+#include "deferred_calls.h"
+#include "deferred_calls.moc"
+
+static LeafbarDeferredCalls *leafbarDeferredCalls = nullptr;
+LeafbarDeferredCalls *LeafbarDeferredCalls::instance() {
+    if (!leafbarDeferredCalls) {
+        leafbarDeferredCalls = new LeafbarDeferredCalls();
+    }
+    return leafbarDeferredCalls;
+}
+
+LeafbarDeferredCalls::LeafbarDeferredCalls()
+: TQObject(),
+  m_scheduled(false),
+  m_requested(0),
+  m_merged(0),
+  m_invoked(0)
+{}
+
+LeafbarDeferredCalls::~LeafbarDeferredCalls() {}
+
+void LeafbarDeferredCalls::call(TQObject *receiver, const char *member)
+{
+    if (!receiver || !member) return;
+    ++m_requested;
+
+    TQString key = TQString("%1:%2").arg((ulong)receiver).arg(member);
+    if (m_keys.contains(key))
+    {
+        ++m_merged;
+        return;
+    }
+
+    // Skip the code TQ_SLOT() prepends to the signature
+    if (receiver->metaObject()->findSlot(member + 1, true) < 0)
+    {
+        kdWarning() << "LeafbarDeferredCalls: no such slot "
+                    << receiver->className() << "::" << (member + 1) << endl;
+        return;
+    }
+    m_keys.insert(key, true);
+
+    Call c;
+    c.receiver = receiver;
+    c.guard = receiver;
+    c.member = member;
+    m_pending.append(c);
+
+    if (!m_receivers.find(receiver))
+    {
+        m_receivers.insert(receiver, receiver);
+        connect(receiver, TQ_SIGNAL(destroyed(TQObject *)),
+                          TQ_SLOT(receiverDestroyed(TQObject *)));
+    }
+
+    if (!m_scheduled)
+    {
+        m_scheduled = true;
+        TQTimer::singleShot(0, this, TQ_SLOT(flush()));
+    }
+}
+
+void LeafbarDeferredCalls::flush()
+{
+    // Calls requested from within the slots we run go to the next iteration.
+    // The list and the signal are local so that a slot running a nested event
+    // loop, which may flush again, cannot disturb them.
+    CallList running = m_pending;
+    m_pending.clear();
+    m_keys.clear();
+    m_scheduled = false;
+
+    TQSignal invoke;
+    CallList::ConstIterator it;
+    for (it = running.begin(); it != running.end(); ++it)
+    {
+        // Null if an earlier slot deleted the receiver
+        TQObject *receiver = (*it).guard;
+        if (!receiver) continue;
+
+        invoke.connect(receiver, (*it).member);
+        invoke.activate();
+        ++m_invoked;
+
+        // The slot may have deleted the receiver, taking the connection along
+        receiver = (*it).guard;
+        if (receiver) invoke.disconnect(receiver, (*it).member);
+    }
+}
+
+void LeafbarDeferredCalls::receiverDestroyed(TQObject *receiver)
+{
+    CallList::Iterator it = m_pending.begin();
+    while (it != m_pending.end())
+    {
+        if ((*it).receiver == receiver)
+        {
+            m_keys.remove(TQString("%1:%2").arg((ulong)receiver).arg((*it).member));
+            it = m_pending.remove(it);
+        }
+        else ++it;
+    }
+
+    m_receivers.remove(receiver);
+}
+
+/* kate: replace-tabs true; tab-width 4; */
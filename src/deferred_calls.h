@@ -0,0 +1,73 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+#ifndef _LEAFBAR_DEFERRED_CALLS_H
+#define _LEAFBAR_DEFERRED_CALLS_H
+
+// TQt
+#include <tqobject.h>
+#include <tqguardedptr.h>
+#include <tqvaluelist.h>
+#include <tqptrdict.h>
+#include <tqmap.h>
+
+#define deferredCalls LeafbarDeferredCalls::instance()
+
+/* Runs slots on the next event loop iteration, like TQTimer::singleShot(0, ...)
+   does, except that any number of requests for the same (receiver, slot) pair
+   made before then result in a single invocation. */
+class LeafbarDeferredCalls : public TQObject {
+  TQ_OBJECT
+
+  public:
+    static LeafbarDeferredCalls *instance();
+
+    void call(TQObject *receiver, const char *member);
+
+    uint requested() const { return m_requested; }
+    uint merged()    const { return m_merged; }
+    uint invoked()   const { return m_invoked; }
+
+  private slots:
+    void flush();
+    void receiverDestroyed(TQObject *receiver);
+
+  private:
+    LeafbarDeferredCalls();
+    ~LeafbarDeferredCalls();
+
+    struct Call
+    {
+      // The receiver keys the call; the guard is cleared when it is deleted
+      TQObject *receiver;
+      TQGuardedPtr<TQObject> guard;
+      TQCString member;
+    };
+    typedef TQValueList<Call> CallList;
+
+    CallList m_pending;
+    TQMap<TQString, bool> m_keys;
+    TQPtrDict<TQObject> m_receivers;
+    bool m_scheduled;
+
+    uint m_requested, m_merged, m_invoked;
+};
+
+#endif // _LEAFBAR_DEFERRED_CALLS_H
+
+/* kate: replace-tabs true; tab-width 2; */
@@ -0,0 +1,203 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+// TQt
+#include <tqapplication.h>
+
+// Leafbar
+#include "icon_fetcher.h"
+
+// X11
+#include <X11/Xlib.h>
+
+// stdlib
+#include <cstdlib>
+#include <cstring>
+
+// Biggest icon we are willing to transfer, in pixels per side
+#define ICON_MAX_SIZE 1024
+
+LeafbarIconFetcher::LeafbarIconFetcher(TQObject *receiver)
+  : TQThread(),
+    m_receiver(receiver),
+    m_connection(nullptr),
+    m_netWmIcon(XCB_ATOM_NONE),
+    m_stop(false)
+{
+    m_connection = xcb_connect(DisplayString(tqt_xdisplay()), nullptr);
+    if (xcb_connection_has_error(m_connection))
+    {
+        xcb_disconnect(m_connection);
+        m_connection = nullptr;
+        return;
+    }
+
+    const char *name = "_NET_WM_ICON";
+    xcb_intern_atom_reply_t *atom = xcb_intern_atom_reply(m_connection,
+        xcb_intern_atom(m_connection, 0, strlen(name), name), nullptr);
+    if (atom)
+    {
+        m_netWmIcon = atom->atom;
+        free(atom);
+    }
+
+    start(TQThread::LowPriority);
+}
+
+LeafbarIconFetcher::~LeafbarIconFetcher()
+{
+    if (!m_connection) return;
+
+    m_mutex.lock();
+    m_stop = true;
+    m_queue.clear();
+    m_wakeUp.wakeAll();
+    m_mutex.unlock();
+
+    wait();
+    xcb_disconnect(m_connection);
+}
+
+void LeafbarIconFetcher::request(WId w, int width, int height, uint revision)
+{
+    Request r;
+    r.window = w;
+    r.width = width;
+    r.height = height;
+    r.revision = revision;
+
+    m_mutex.lock();
+    m_queue.append(r);
+    m_wakeUp.wakeAll();
+    m_mutex.unlock();
+}
+
+void LeafbarIconFetcher::run()
+{
+    for (;;)
+    {
+        m_mutex.lock();
+        while (m_queue.isEmpty() && !m_stop)
+        {
+            m_wakeUp.wait(&m_mutex);
+        }
+        if (m_stop)
+        {
+            m_mutex.unlock();
+            return;
+        }
+        Request r = m_queue.first();
+        m_queue.remove(m_queue.begin());
+        m_mutex.unlock();
+
+        // The image must only be referenced by the event once it is posted
+        LeafbarIconEvent *e;
+        {
+            ulong bytes = 0;
+            TQImage image = fetch(m_connection, m_netWmIcon, r.window, r.width, r.height, &bytes);
+            e = new LeafbarIconEvent(r.window, r.width, r.height, r.revision, image, bytes);
+        }
+        TQApplication::postEvent(m_receiver, e);
+    }
+}
+
+/* Reads part of _NET_WM_ICON, or returns null if the window has no such
+   property or is gone */
+static xcb_get_property_reply_t *readIcon(xcb_connection_t *c, xcb_atom_t netWmIcon,
+                                          WId w, long offset, long length)
+{
+    xcb_generic_error_t *error = nullptr;
+    xcb_get_property_reply_t *r = xcb_get_property_reply(c,
+        xcb_get_property(c, 0, w, netWmIcon, XCB_ATOM_CARDINAL, offset, length), &error);
+    free(error);
+
+    if (r && (r->type != XCB_ATOM_CARDINAL || r->format != 32))
+    {
+        free(r);
+        return nullptr;
+    }
+    return r;
+}
+
+/* _NET_WM_ICON holds any number of width, height, pixels... entries, often
+   adding up to hundreds of kilobytes. The entry headers are read two values
+   at a time, then only the pixels of the best fitting entry are transferred:
+   the smallest one at least as big as asked for, or else the biggest one. */
+TQImage LeafbarIconFetcher::fetch(xcb_connection_t *c, xcb_atom_t netWmIcon,
+                                  WId w, int width, int height, ulong *bytes)
+{
+    if (netWmIcon == XCB_ATOM_NONE) return TQImage();
+
+    long offset = 0, bestOffset = -1;
+    int bestWidth = 0, bestHeight = 0;
+    for (;;)
+    {
+        xcb_get_property_reply_t *r = readIcon(c, netWmIcon, w, offset, 2);
+        if (!r) break;
+
+        uint32_t *header = (uint32_t *)xcb_get_property_value(r);
+        bool ok = (xcb_get_property_value_length(r) == 8);
+        long iw = ok ? header[0] : 0, ih = ok ? header[1] : 0;
+        ok = ok && iw > 0 && ih > 0 && iw <= ICON_MAX_SIZE && ih <= ICON_MAX_SIZE;
+        uint32_t after = r->bytes_after;
+        free(r);
+        if (!ok) break;
+        *bytes += 8;
+
+        bool fits = iw >= width && ih >= height;
+        bool bestFits = bestWidth >= width && bestHeight >= height;
+        if (bestOffset < 0 ||
+            (fits ? (!bestFits || iw < bestWidth) : (!bestFits && iw > bestWidth)))
+        {
+            bestOffset = offset + 2;
+            bestWidth = iw;
+            bestHeight = ih;
+        }
+
+        offset += 2 + iw * ih;
+        if (after <= (uint32_t)(iw * ih * 4)) break;
+    }
+
+    if (bestOffset < 0) return TQImage();
+
+    long length = bestWidth * bestHeight;
+    xcb_get_property_reply_t *r = readIcon(c, netWmIcon, w, bestOffset, length);
+    if (!r || xcb_get_property_value_length(r) != length * 4)
+    {
+        free(r);
+        return TQImage();
+    }
+    *bytes += length * 4;
+
+    TQImage img(bestWidth, bestHeight, 32);
+    img.setAlphaBuffer(true);
+    uint32_t *pixels = (uint32_t *)xcb_get_property_value(r);
+    for (int y = 0; y < bestHeight; ++y)
+    {
+        memcpy(img.scanLine(y), pixels + y * bestWidth, bestWidth * 4);
+    }
+    free(r);
+
+    if (img.width() != width || img.height() != height)
+    {
+        img = img.smoothScale(width, height);
+    }
+    return img;
+}
+
+/* kate: replace-tabs true; tab-width 4; */
@@ -0,0 +1,102 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+#ifndef _LEAFBAR_ICON_FETCHER_H
+#define _LEAFBAR_ICON_FETCHER_H
+
+// TQt
+#include <tqthread.h>
+#include <tqmutex.h>
+#include <tqwaitcondition.h>
+#include <tqevent.h>
+#include <tqimage.h>
+#include <tqvaluelist.h>
+
+// X11
+#include <xcb/xcb.h>
+
+// Posted to the receiver of LeafbarIconFetcher when an icon is ready
+class LeafbarIconEvent : public TQCustomEvent {
+  public:
+    enum { Type = TQEvent::User + 0x1eaf };
+
+    LeafbarIconEvent(WId w, int width, int height, uint revision,
+                     const TQImage &image, ulong bytes)
+      : TQCustomEvent(Type),
+        m_window(w), m_width(width), m_height(height),
+        m_revision(revision), m_image(image), m_bytes(bytes)
+    {}
+
+    WId window() const { return m_window; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    uint revision() const { return m_revision; }
+    TQImage image() const { return m_image; }
+    ulong bytes() const { return m_bytes; }
+
+  private:
+    WId m_window;
+    int m_width, m_height;
+    uint m_revision;
+    TQImage m_image;
+    ulong m_bytes;
+};
+
+/* Reads _NET_WM_ICON in a worker thread over an XCB connection of its own,
+   so that big icons do not hold up the GUI thread. XCB is thread safe and
+   hands errors back with each reply, so a window that is gone by the time
+   its icon is fetched never reaches Xlib's global error handler. Only the
+   best fitting entry of the property is transferred (see fetch()). Results
+   are posted to the receiver as LeafbarIconEvents; a null image means the
+   window has no usable _NET_WM_ICON. */
+class LeafbarIconFetcher : public TQThread {
+  public:
+    LeafbarIconFetcher(TQObject *receiver);
+    ~LeafbarIconFetcher();
+
+    bool valid() const { return m_connection != nullptr; }
+    void request(WId w, int width, int height, uint revision);
+
+    // Usable from any thread with the given connection and its _NET_WM_ICON atom
+    static TQImage fetch(xcb_connection_t *c, xcb_atom_t netWmIcon,
+                         WId w, int width, int height, ulong *bytes);
+
+  protected:
+    void run();
+
+  private:
+    struct Request
+    {
+      WId window;
+      int width, height;
+      uint revision;
+    };
+
+    TQObject *m_receiver;
+    xcb_connection_t *m_connection;
+    xcb_atom_t m_netWmIcon;
+
+    TQMutex m_mutex;
+    TQWaitCondition m_wakeUp;
+    TQValueList<Request> m_queue;
+    bool m_stop;
+};
+
+#endif // _LEAFBAR_ICON_FETCHER_H
+
+/* kate: replace-tabs true; tab-width 2; */
@@ -19,6 +19,9 @@
 #ifndef _LEAFBARIFACE_H
 #define _LEAFBARIFACE_H
 
+// TQt
+#include <tqstringlist.h>
+
 // TDE
 #include <dcopobject.h>
 
@@ -29,6 +32,8 @@ class LeafbarIface: virtual public DCOPObject {
     virtual bool ping() = 0;
     virtual void reconfigure() = 0;
     virtual void reloadApplet(TQString) = 0;
+    virtual TQStringList stats() = 0;
+    virtual TQStringList appletStats(TQString) = 0;
     virtual void quit() = 0;
 };
 
@@ -121,7 +121,7 @@ void LeafbarPanel::reconfigure()
 {
     LeafbarSettings::self()->readConfig();
     applySize();
-    TQTimer::singleShot(0, this, TQ_SLOT(relayout()));
+    deferredCalls->call(this, TQ_SLOT(relayout()));
 }
 
 void LeafbarPanel::reloadApplet(TQString appletId)
@@ -135,7 +135,7 @@ void LeafbarPanel::reloadApplet(TQString appletId)
 
     unloadApplet(applet);
     loadApplet(applet);
-    TQTimer::singleShot(0, this, TQ_SLOT(relayout()));
+    deferredCalls->call(this, TQ_SLOT(relayout()));
 }
 
 TQPoint LeafbarPanel::originPos() const
@@ -313,6 +313,49 @@ void LeafbarPanel::relayout() {
     }
 }
 
+/* Panel-wide statistics followed by those of each loaded applet, the latter
+   prefixed with the applet id */
+TQStringList LeafbarPanel::stats()
+{
+    TQStringList lines;
+    lines << TQString("peakMemory=%1").arg(LeafbarAppletStats::peakMemory());
+    lines << TQString("deferredCallsRequested=%1").arg(deferredCalls->requested());
+    lines << TQString("deferredCallsMerged=%1").arg(deferredCalls->merged());
+    lines << TQString("deferredCallsInvoked=%1").arg(deferredCalls->invoked());
+    lines << TQString("windowEventsDelivered=%1").arg(windowEvents->delivered());
+    lines << TQString("windowEventsDropped=%1").arg(windowEvents->dropped());
+    lines << TQString("windowModelWindows=%1").arg(panelExt->windowModel()->count());
+    lines << TQString("windowModelFetches=%1").arg(panelExt->windowModel()->fetches());
+    lines << TQString("windowModelIconBytes=%1").arg(panelExt->windowModel()->iconBytes());
+
+    AppletData *applet = m_applets.first();
+    for (; applet; applet = m_applets.next()) {
+        if (!applet->ptr) continue;
+
+        applet->ptr->updateStats();
+        TQStringList appletLines = applet->ptr->stats()->report();
+        TQStringList::Iterator it;
+        for (it = appletLines.begin(); it != appletLines.end(); ++it) {
+            lines << TQString("%1.%2").arg(TQString(applet->id)).arg(*it);
+        }
+    }
+
+    return lines;
+}
+
+TQStringList LeafbarPanel::appletStats(TQString appletId)
+{
+    if (appletId.isNull() || !m_appletDB->contains(appletId)) {
+        return TQStringList();
+    }
+
+    AppletData &applet = (*m_appletDB)[appletId];
+    if (!applet.ptr) return TQStringList();
+
+    applet.ptr->updateStats();
+    return applet.ptr->stats()->report();
+}
+
 void LeafbarPanel::popup(TQString icon, TQString caption, TQString message) {
     KPassivePopup::message(caption, message, SmallIcon(icon), this);
 }
@@ -76,6 +76,9 @@ class LeafbarPanel : public TQFrame {
     void reloadApplet(TQString appletId);
     void relayout();
 
+    TQStringList stats();
+    TQStringList appletStats(TQString appletId);
+
   signals:
     void appletsReconfigure();
 
@@ -0,0 +1,160 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+// TDE
+#include <tdeapplication.h>
+#include <netwm_def.h>
+
+// Leafbar
+#include "window_events.h"
+#include "window_events.moc"
+
+// X11
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+
+LeafbarWindowFilter::LeafbarWindowFilter(TQObject *parent, unsigned long properties,
+                                         unsigned long properties2)
+: TQObject(parent),
+  m_properties(properties),
+  m_properties2(properties2)
+{}
+
+LeafbarWindowFilter::~LeafbarWindowFilter()
+{
+    windowEvents->unsubscribe(this);
+}
+
+static LeafbarWindowEvents *leafbarWindowEvents = nullptr;
+LeafbarWindowEvents *LeafbarWindowEvents::instance() {
+    if (!leafbarWindowEvents) {
+        leafbarWindowEvents = new LeafbarWindowEvents();
+    }
+    return leafbarWindowEvents;
+}
+
+LeafbarWindowEvents::LeafbarWindowEvents()
+: TQWidget(nullptr, "LeafbarWindowEvents"),
+  m_properties(0),
+  m_properties2(0),
+  m_delivered(0),
+  m_dropped(0)
+{
+    // The same atoms KWinModule maps to NET properties
+    addAtom("WM_NAME",                   NET::WMName);
+    addAtom("_NET_WM_NAME",              NET::WMName);
+    addAtom("_NET_WM_VISIBLE_NAME",      NET::WMVisibleName);
+    addAtom("WM_ICON_NAME",              NET::WMIconName);
+    addAtom("_NET_WM_ICON_NAME",         NET::WMIconName);
+    addAtom("_NET_WM_VISIBLE_ICON_NAME", NET::WMVisibleIconName);
+    addAtom("WM_HINTS",                  NET::WMIcon);
+    addAtom("_NET_WM_ICON",              NET::WMIcon);
+    addAtom("KWM_WIN_ICON",              NET::WMIcon);
+    addAtom("_NET_WM_STATE",             NET::WMState);
+    addAtom("WM_STATE",                  NET::XAWMState);
+    addAtom("_NET_WM_DESKTOP",           NET::WMDesktop);
+    addAtom("_NET_WM_WINDOW_TYPE",       NET::WMWindowType);
+    addAtom("_NET_WM_PID",               NET::WMPid);
+    addAtom("_NET_WM_STRUT",             NET::WMStrut);
+    addAtom("WM_CLASS",                  0, NET::WM2WindowClass);
+    addAtom("WM_WINDOW_ROLE",            0, NET::WM2WindowRole);
+
+    tdeApp->installX11EventFilter(this);
+}
+
+LeafbarWindowEvents::~LeafbarWindowEvents()
+{
+    tdeApp->removeX11EventFilter(this);
+}
+
+void LeafbarWindowEvents::addAtom(const char *name, unsigned long property,
+                                  unsigned long property2)
+{
+    Property p;
+    p.property = property;
+    p.property2 = property2;
+    m_atoms.insert(XInternAtom(tqt_xdisplay(), name, False), p);
+}
+
+LeafbarWindowFilter *LeafbarWindowEvents::subscribe(TQObject *parent,
+                                                    unsigned long properties,
+                                                    unsigned long properties2)
+{
+    LeafbarWindowFilter *filter = new LeafbarWindowFilter(parent, properties, properties2);
+    m_filters.append(filter);
+    m_properties |= properties;
+    m_properties2 |= properties2;
+    return filter;
+}
+
+void LeafbarWindowEvents::unsubscribe(LeafbarWindowFilter *filter)
+{
+    m_filters.removeRef(filter);
+
+    m_properties = m_properties2 = 0;
+    TQPtrListIterator<LeafbarWindowFilter> it(m_filters);
+    for (; it.current(); ++it)
+    {
+        m_properties |= it.current()->properties();
+        m_properties2 |= it.current()->properties2();
+    }
+}
+
+/* Never eats the event: KWinModule and TQt still get to see it. */
+bool LeafbarWindowEvents::x11Event(XEvent *ev)
+{
+    if (ev->type == PropertyNotify)
+    {
+        TQMap<unsigned long, Property>::ConstIterator it = m_atoms.find(ev->xproperty.atom);
+        if (it == m_atoms.end() ||
+            (!(it.data().property & m_properties) && !(it.data().property2 & m_properties2)))
+        {
+            ++m_dropped;
+            return false;
+        }
+        dispatch(ev->xproperty.window, it.data().property, it.data().property2);
+    }
+    else if (ev->type == ConfigureNotify && (m_properties & NET::WMGeometry))
+    {
+        // Skip our own widgets, TQt selects StructureNotify on those too
+        if (ev->xconfigure.window == ev->xconfigure.event &&
+            !TQWidget::find(ev->xconfigure.window))
+        {
+            dispatch(ev->xconfigure.window, NET::WMGeometry, 0);
+        }
+    }
+    return false;
+}
+
+void LeafbarWindowEvents::dispatch(WId w, unsigned long property, unsigned long property2)
+{
+    TQPtrListIterator<LeafbarWindowFilter> it(m_filters);
+    for (; it.current(); ++it)
+    {
+        LeafbarWindowFilter *f = it.current();
+        unsigned long p = property & f->properties();
+        unsigned long p2 = property2 & f->properties2();
+        if (p || p2)
+        {
+            ++m_delivered;
+            emit f->windowChanged(w, p, p2);
+        }
+    }
+}
+
+/* kate: replace-tabs true; tab-width 4; */
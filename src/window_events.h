@@ -0,0 +1,98 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+#ifndef _LEAFBAR_WINDOW_EVENTS_H
+#define _LEAFBAR_WINDOW_EVENTS_H
+
+// TQt
+#include <tqwidget.h>
+#include <tqptrlist.h>
+#include <tqmap.h>
+
+#define windowEvents LeafbarWindowEvents::instance()
+
+/* One subscription to LeafbarWindowEvents. Emits windowChanged() only for
+   the properties it was created for; delete it to unsubscribe. */
+class LeafbarWindowFilter : public TQObject {
+  TQ_OBJECT
+
+  public:
+    ~LeafbarWindowFilter();
+
+    unsigned long properties()  const { return m_properties; }
+    unsigned long properties2() const { return m_properties2; }
+
+  signals:
+    void windowChanged(WId w, unsigned int properties, unsigned int properties2);
+
+  private:
+    LeafbarWindowFilter(TQObject *parent, unsigned long properties,
+                        unsigned long properties2);
+
+    unsigned long m_properties, m_properties2;
+
+  friend class LeafbarWindowEvents;
+};
+
+/* Property change notifications for client windows, filtered by atom before
+   anything is decoded. Changes to properties no applet subscribed to, such as
+   _NET_WM_USER_TIME, are dropped right away.
+
+   The property masks are the NET::Property and NET::Property2 ones used by
+   KWinModule. Client windows are the ones KWinModule selects input on, so an
+   applet still needs a KWinModule to track the window list itself. */
+class LeafbarWindowEvents : public TQWidget {
+  TQ_OBJECT
+
+  public:
+    static LeafbarWindowEvents *instance();
+
+    LeafbarWindowFilter *subscribe(TQObject *parent, unsigned long properties,
+                                   unsigned long properties2 = 0);
+
+    uint delivered() const { return m_delivered; }
+    uint dropped()   const { return m_dropped; }
+
+  protected:
+    bool x11Event(XEvent *ev);
+
+  private:
+    LeafbarWindowEvents();
+    ~LeafbarWindowEvents();
+
+    void addAtom(const char *name, unsigned long property, unsigned long property2 = 0);
+    void unsubscribe(LeafbarWindowFilter *filter);
+    void dispatch(WId w, unsigned long property, unsigned long property2);
+
+    struct Property
+    {
+      unsigned long property, property2;
+    };
+    TQMap<unsigned long, Property> m_atoms;
+
+    TQPtrList<LeafbarWindowFilter> m_filters;
+    unsigned long m_properties, m_properties2;
+
+    uint m_delivered, m_dropped;
+
+  friend class LeafbarWindowFilter;
+};
+
+#endif // _LEAFBAR_WINDOW_EVENTS_H
+
+/* kate: replace-tabs true; tab-width 2; */
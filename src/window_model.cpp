@@ -0,0 +1,638 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+// TQt
+#include <tqfile.h>
+#include <tqfileinfo.h>
+
+// TDE
+#include <twinmodule.h>
+
+// Leafbar
+#include "icon_fetcher.h"
+#include "window_events.h"
+#include "window_model.h"
+#include "window_model.moc"
+
+// X11
+#include <X11/Xlib-xcb.h>
+#include <xcb/xcb.h>
+
+// stdlib
+#include <cstdlib>
+#include <cstring>
+
+// Longest window name we transfer, in 32-bit units
+#define WINDOW_NAME_MAX_LENGTH 1024
+
+// WM_STATE value of iconified windows (ICCCM 4.1.3.1)
+#define WM_STATE_ICONIC 3
+
+enum
+{
+    NetWmWindowType = 0,
+    NetWmState,
+    NetWmVisibleName,
+    NetWmName,
+    NetWmDesktop,
+    NetWmPid,
+    WmState,
+    Utf8String,
+    NetWmIcon,
+
+    // Window types, in the order of windowTypes below
+    NetWmWindowTypeNormal,
+    NetWmWindowTypeDesktop,
+    NetWmWindowTypeDock,
+    NetWmWindowTypeToolbar,
+    NetWmWindowTypeMenu,
+    NetWmWindowTypeDialog,
+    NetWmWindowTypeUtility,
+    NetWmWindowTypeSplash,
+    KdeNetWmWindowTypeOverride,
+    KdeNetWmWindowTypeTopMenu,
+
+    // Window states, in the order of windowStates below
+    NetWmStateModal,
+    NetWmStateSticky,
+    NetWmStateMaximizedVert,
+    NetWmStateMaximizedHorz,
+    NetWmStateShaded,
+    NetWmStateSkipTaskbar,
+    NetWmStateSkipPager,
+    NetWmStateHidden,
+    NetWmStateFullScreen,
+    NetWmStateAbove,
+    NetWmStateBelow,
+    NetWmStateDemandsAttention,
+    KdeNetWmStateStaysOnTop,
+
+    ATOM_COUNT
+};
+
+static const char *atomNames[ATOM_COUNT] = {
+    "_NET_WM_WINDOW_TYPE",
+    "_NET_WM_STATE",
+    "_NET_WM_VISIBLE_NAME",
+    "_NET_WM_NAME",
+    "_NET_WM_DESKTOP",
+    "_NET_WM_PID",
+    "WM_STATE",
+    "UTF8_STRING",
+    "_NET_WM_ICON",
+
+    "_NET_WM_WINDOW_TYPE_NORMAL",
+    "_NET_WM_WINDOW_TYPE_DESKTOP",
+    "_NET_WM_WINDOW_TYPE_DOCK",
+    "_NET_WM_WINDOW_TYPE_TOOLBAR",
+    "_NET_WM_WINDOW_TYPE_MENU",
+    "_NET_WM_WINDOW_TYPE_DIALOG",
+    "_NET_WM_WINDOW_TYPE_UTILITY",
+    "_NET_WM_WINDOW_TYPE_SPLASH",
+    "_KDE_NET_WM_WINDOW_TYPE_OVERRIDE",
+    "_KDE_NET_WM_WINDOW_TYPE_TOPMENU",
+
+    "_NET_WM_STATE_MODAL",
+    "_NET_WM_STATE_STICKY",
+    "_NET_WM_STATE_MAXIMIZED_VERT",
+    "_NET_WM_STATE_MAXIMIZED_HORZ",
+    "_NET_WM_STATE_SHADED",
+    "_NET_WM_STATE_SKIP_TASKBAR",
+    "_NET_WM_STATE_SKIP_PAGER",
+    "_NET_WM_STATE_HIDDEN",
+    "_NET_WM_STATE_FULLSCREEN",
+    "_NET_WM_STATE_ABOVE",
+    "_NET_WM_STATE_BELOW",
+    "_NET_WM_STATE_DEMANDS_ATTENTION",
+    "_KDE_NET_WM_STATE_STAYS_ON_TOP"
+};
+
+static const NET::WindowType windowTypes[] = {
+    NET::Normal, NET::Desktop, NET::Dock, NET::Toolbar, NET::Menu,
+    NET::Dialog, NET::Utility, NET::Splash, NET::Override, NET::TopMenu
+};
+
+static const unsigned long windowStates[] = {
+    NET::Modal, NET::Sticky, NET::MaxVert, NET::MaxHoriz, NET::Shaded,
+    NET::SkipTaskbar, NET::SkipPager, NET::Hidden, NET::FullScreen,
+    NET::KeepAbove, NET::KeepBelow, NET::DemandsAttention, NET::StaysOnTop
+};
+
+static xcb_atom_t atoms[ATOM_COUNT];
+
+/* Xlib sits on top of XCB; through its connection, requests can be sent
+   without waiting for their replies, and errors are handed back with the
+   reply instead of going to the global X error handler. */
+static xcb_connection_t *connection()
+{
+    static xcb_connection_t *c = nullptr;
+    if (c) return c;
+
+    c = XGetXCBConnection(tqt_xdisplay());
+
+    xcb_intern_atom_cookie_t cookies[ATOM_COUNT];
+    for (int i = 0; i < ATOM_COUNT; ++i)
+    {
+        cookies[i] = xcb_intern_atom(c, 0, strlen(atomNames[i]), atomNames[i]);
+    }
+    for (int i = 0; i < ATOM_COUNT; ++i)
+    {
+        xcb_intern_atom_reply_t *r = xcb_intern_atom_reply(c, cookies[i], nullptr);
+        atoms[i] = r ? r->atom : XCB_ATOM_NONE;
+        free(r);
+    }
+    return c;
+}
+
+/* One batch of property requests for a window, see LeafbarWindowModel::fetch() */
+struct LeafbarWindowRequests
+{
+    LeafbarWindowInfo *info;
+    unsigned long props, props2;
+    xcb_get_geometry_cookie_t geometry;
+    xcb_translate_coordinates_cookie_t position;
+    xcb_get_property_cookie_t type, state, wmState, visibleName, name, wmName,
+                              desktop, pid, wmClass;
+};
+
+/* The reply to a property request, or null if the property is not set or
+   the window is gone */
+static xcb_get_property_reply_t *reply(xcb_connection_t *c, xcb_get_property_cookie_t cookie)
+{
+    xcb_generic_error_t *error = nullptr;
+    xcb_get_property_reply_t *r = xcb_get_property_reply(c, cookie, &error);
+    free(error);
+
+    if (r && r->type == XCB_ATOM_NONE)
+    {
+        free(r);
+        return nullptr;
+    }
+    return r;
+}
+
+// The helpers below take ownership of the reply
+
+static TQValueList<ulong> cardinals(xcb_get_property_reply_t *r)
+{
+    TQValueList<ulong> values;
+    if (!r) return values;
+
+    if (r->format == 32)
+    {
+        uint32_t *data = (uint32_t *)xcb_get_property_value(r);
+        int count = xcb_get_property_value_length(r) / 4;
+        for (int i = 0; i < count; ++i)
+        {
+            values.append(data[i]);
+        }
+    }
+    free(r);
+    return values;
+}
+
+static TQString utf8(xcb_get_property_reply_t *r)
+{
+    if (!r) return TQString::null;
+
+    TQString s = TQString::fromUtf8((const char *)xcb_get_property_value(r),
+                                   xcb_get_property_value_length(r));
+    free(r);
+    return s;
+}
+
+// WM_NAME is either Latin-1 or in the locale's encoding
+static TQString text(xcb_get_property_reply_t *r)
+{
+    if (!r) return TQString::null;
+
+    const char *data = (const char *)xcb_get_property_value(r);
+    int length = xcb_get_property_value_length(r);
+    TQString s = (r->type == XCB_ATOM_STRING) ? TQString::fromLatin1(data, length)
+                                              : TQString::fromLocal8Bit(data, length);
+    free(r);
+    return s;
+}
+
+static NET::WindowType windowType(ulong atom)
+{
+    for (int i = NetWmWindowTypeNormal; i <= KdeNetWmWindowTypeTopMenu; ++i)
+    {
+        if (atoms[i] == atom) return windowTypes[i - NetWmWindowTypeNormal];
+    }
+    return NET::Unknown;
+}
+
+static unsigned long windowState(ulong atom)
+{
+    for (int i = NetWmStateModal; i <= KdeNetWmStateStaysOnTop; ++i)
+    {
+        if (atoms[i] == atom) return windowStates[i - NetWmStateModal];
+    }
+    return 0;
+}
+
+LeafbarWindowInfo::LeafbarWindowInfo(WId w)
+: m_window(w),
+  m_valid(false),
+  m_type(NET::Unknown),
+  m_state(0),
+  m_minimized(false),
+  m_desktop(-1),
+  m_pid(0),
+  m_iconRevision(0),
+  m_stale(WINDOW_MODEL_PROPERTIES),
+  m_stale2(WINDOW_MODEL_PROPERTIES2)
+{}
+
+LeafbarWindowModel::LeafbarWindowModel(TQObject *parent)
+: TQObject(parent, "LeafbarWindowModel"),
+  m_fetches(0),
+  m_iconBytes(0)
+{
+    m_windows.setAutoDelete(true);
+    m_fetcher = new LeafbarIconFetcher(this);
+
+    m_twin = new KWinModule(this);
+
+    const TQValueList<WId> &windows = m_twin->windows();
+    TQValueList<WId>::ConstIterator it;
+    for (it = windows.begin(); it != windows.end(); ++it)
+    {
+        m_windows.insert((*it), new LeafbarWindowInfo((*it)));
+    }
+
+    connect(m_twin, TQ_SIGNAL(windowAdded(WId)), TQ_SLOT(slotWindowAdded(WId)));
+    connect(m_twin, TQ_SIGNAL(windowRemoved(WId)), TQ_SLOT(slotWindowRemoved(WId)));
+
+    LeafbarWindowFilter *filter = windowEvents->subscribe(this,
+        WINDOW_MODEL_PROPERTIES | NET::WMIcon, WINDOW_MODEL_PROPERTIES2);
+    connect(filter, TQ_SIGNAL(windowChanged(WId, unsigned int, unsigned int)),
+                    TQ_SLOT(slotWindowChanged(WId, unsigned int, unsigned int)));
+}
+
+LeafbarWindowModel::~LeafbarWindowModel()
+{
+    delete m_fetcher;
+}
+
+const LeafbarWindowInfo *LeafbarWindowModel::info(WId w)
+{
+    LeafbarWindowInfo *i = m_windows[w];
+    if (i && (i->m_stale || i->m_stale2))
+    {
+        TQValueList<LeafbarWindowInfo *> infos;
+        infos.append(i);
+        fetch(infos);
+    }
+    return i;
+}
+
+/* Brings the given windows up to date in one go, see fetch(). Meant for
+   when many windows are about to be asked for, such as at startup. */
+void LeafbarWindowModel::prefetch(const TQValueList<WId> &windows)
+{
+    TQValueList<LeafbarWindowInfo *> infos;
+    TQValueList<WId>::ConstIterator it;
+    for (it = windows.begin(); it != windows.end(); ++it)
+    {
+        LeafbarWindowInfo *i = m_windows[(*it)];
+        if (i && (i->m_stale || i->m_stale2))
+        {
+            infos.append(i);
+        }
+    }
+
+    if (!infos.isEmpty())
+    {
+        fetch(infos);
+    }
+}
+
+/* Reads the stale properties of the given windows. All requests for all
+   windows are sent before the first reply is waited for, so that the whole
+   batch costs a single round trip. Errors, such as for a window that is gone
+   already, come back with the reply they belong to. */
+void LeafbarWindowModel::fetch(const TQValueList<LeafbarWindowInfo *> &infos)
+{
+    TQValueList<LeafbarWindowRequests> requests;
+    TQValueList<LeafbarWindowInfo *>::ConstIterator it;
+    for (it = infos.begin(); it != infos.end(); ++it)
+    {
+        LeafbarWindowRequests r;
+        r.info = (*it);
+        sendRequests(r);
+        requests.append(r);
+    }
+
+    ++m_fetches;
+
+    TQValueList<LeafbarWindowRequests>::Iterator rit;
+    for (rit = requests.begin(); rit != requests.end(); ++rit)
+    {
+        readReplies((*rit));
+    }
+}
+
+void LeafbarWindowModel::sendRequests(LeafbarWindowRequests &r)
+{
+    xcb_connection_t *c = connection();
+    LeafbarWindowInfo *i = r.info;
+    r.props = i->m_stale;
+    r.props2 = i->m_stale2;
+    i->m_stale = i->m_stale2 = 0;
+
+    // The visible name reflects the iconified and shaded states
+    if (r.props & (NET::WMState | NET::XAWMState | NET::WMName | NET::WMVisibleName))
+    {
+        r.props |= NET::WMState | NET::XAWMState | NET::WMName | NET::WMVisibleName;
+    }
+
+    xcb_window_t w = i->m_window;
+
+    // Always asked for, it tells whether the window still exists
+    r.geometry = xcb_get_geometry(c, w);
+    if (r.props & NET::WMGeometry)
+    {
+        r.position = xcb_translate_coordinates(c, w, tqt_xrootwin(), 0, 0);
+    }
+
+    if (r.props & NET::WMWindowType)
+    {
+        r.type = xcb_get_property(c, 0, w, atoms[NetWmWindowType], XCB_ATOM_ATOM, 0, 32);
+    }
+
+    if (r.props & NET::WMState)
+    {
+        r.state = xcb_get_property(c, 0, w, atoms[NetWmState], XCB_ATOM_ATOM, 0, 32);
+        r.wmState = xcb_get_property(c, 0, w, atoms[WmState], atoms[WmState], 0, 2);
+        r.visibleName = xcb_get_property(c, 0, w, atoms[NetWmVisibleName],
+                                         atoms[Utf8String], 0, WINDOW_NAME_MAX_LENGTH);
+        r.name = xcb_get_property(c, 0, w, atoms[NetWmName],
+                                  atoms[Utf8String], 0, WINDOW_NAME_MAX_LENGTH);
+        r.wmName = xcb_get_property(c, 0, w, XCB_ATOM_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY,
+                                    0, WINDOW_NAME_MAX_LENGTH);
+    }
+
+    if (r.props & NET::WMDesktop)
+    {
+        r.desktop = xcb_get_property(c, 0, w, atoms[NetWmDesktop], XCB_ATOM_CARDINAL, 0, 1);
+    }
+
+    if (r.props & NET::WMPid)
+    {
+        r.pid = xcb_get_property(c, 0, w, atoms[NetWmPid], XCB_ATOM_CARDINAL, 0, 1);
+    }
+
+    if (r.props2 & NET::WM2WindowClass)
+    {
+        r.wmClass = xcb_get_property(c, 0, w, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 0, 256);
+    }
+}
+
+void LeafbarWindowModel::readReplies(LeafbarWindowRequests &r)
+{
+    xcb_connection_t *c = connection();
+    LeafbarWindowInfo *i = r.info;
+    xcb_generic_error_t *error = nullptr;
+
+    xcb_get_geometry_reply_t *geometry = xcb_get_geometry_reply(c, r.geometry, &error);
+    free(error);
+    i->m_valid = (geometry != nullptr);
+
+    if (r.props & NET::WMGeometry)
+    {
+        error = nullptr;
+        xcb_translate_coordinates_reply_t *position =
+            xcb_translate_coordinates_reply(c, r.position, &error);
+        free(error);
+        if (geometry && position)
+        {
+            i->m_geometry = TQRect(position->dst_x, position->dst_y,
+                                   geometry->width, geometry->height);
+        }
+        else
+        {
+            i->m_geometry = TQRect();
+        }
+        free(position);
+    }
+    free(geometry);
+
+    if (r.props & NET::WMWindowType)
+    {
+        i->m_type = NET::Unknown;
+        TQValueList<ulong> types = cardinals(reply(c, r.type));
+        TQValueList<ulong>::ConstIterator it;
+        for (it = types.begin(); it != types.end() && i->m_type == NET::Unknown; ++it)
+        {
+            i->m_type = windowType((*it));
+        }
+    }
+
+    if (r.props & NET::WMState)
+    {
+        i->m_state = 0;
+        TQValueList<ulong> states = cardinals(reply(c, r.state));
+        TQValueList<ulong>::ConstIterator it;
+        for (it = states.begin(); it != states.end(); ++it)
+        {
+            i->m_state |= windowState((*it));
+        }
+
+        // NETWM compliant window managers hide minimized windows; shaded
+        // windows may be hidden too
+        TQValueList<ulong> wmState = cardinals(reply(c, r.wmState));
+        bool iconic = !wmState.isEmpty() && wmState.first() == WM_STATE_ICONIC;
+        i->m_minimized = iconic && (i->m_state & NET::Hidden) && !(i->m_state & NET::Shaded);
+
+        TQString name = utf8(reply(c, r.visibleName));
+        TQString netName = utf8(reply(c, r.name));
+        TQString wmName = text(reply(c, r.wmName));
+        if (name.isEmpty()) name = netName;
+        if (name.isEmpty()) name = wmName;
+
+        i->m_visibleName = i->m_minimized ? TQString("(%1)").arg(name) : name;
+    }
+
+    if (r.props & NET::WMDesktop)
+    {
+        TQValueList<ulong> desktop = cardinals(reply(c, r.desktop));
+        if (!i->m_valid) i->m_desktop = -1;
+        else if (desktop.isEmpty()) i->m_desktop = 0;
+        else if (desktop.first() == 0xffffffff) i->m_desktop = 0;
+        else i->m_desktop = desktop.first() + 1;
+    }
+
+    if (r.props & NET::WMPid)
+    {
+        TQValueList<ulong> pids = cardinals(reply(c, r.pid));
+        int pid = pids.isEmpty() ? 0 : (int)pids.first();
+        if (pid != i->m_pid)
+        {
+            i->m_pid = pid;
+            resolveProcess(i);
+        }
+    }
+
+    if (r.props2 & NET::WM2WindowClass)
+    {
+        // Instance and class, each terminated by a null byte
+        i->m_resName = i->m_resClass = TQString::null;
+        xcb_get_property_reply_t *p = reply(c, r.wmClass);
+        if (p)
+        {
+            const char *data = (const char *)xcb_get_property_value(p);
+            int length = xcb_get_property_value_length(p);
+            int split = strnlen(data, length);
+            i->m_resName = TQString::fromLatin1(data, split);
+            if (split + 1 < length)
+            {
+                i->m_resClass = TQString::fromLatin1(data + split + 1,
+                                                     strnlen(data + split + 1, length - split - 1));
+            }
+            free(p);
+        }
+    }
+}
+
+/* Returns the icon of the given size, or a null image while it is being
+   fetched by the icon fetcher thread; iconReady() is emitted once it is
+   there. Without a fetcher thread the icon is fetched right away. */
+TQImage LeafbarWindowModel::icon(WId w, int width, int height)
+{
+    LeafbarWindowInfo *i = m_windows[w];
+    if (!i) return TQImage();
+
+    TQString key = TQString("%1x%2").arg(width).arg(height);
+    TQMap<TQString, TQImage>::ConstIterator it = i->m_icons.find(key);
+    if (it != i->m_icons.end())
+    {
+        return it.data();
+    }
+
+    if (!m_fetcher->valid())
+    {
+        ulong bytes = 0;
+        storeIcon(i, width, height,
+                  LeafbarIconFetcher::fetch(connection(), atoms[NetWmIcon],
+                                            w, width, height, &bytes));
+        m_iconBytes += bytes;
+        return i->m_icons[key];
+    }
+
+    if (!i->m_iconRequests.contains(key))
+    {
+        i->m_iconRequests.insert(key, true);
+        m_fetcher->request(w, width, height, i->m_iconRevision);
+    }
+    return TQImage();
+}
+
+/* Windows without _NET_WM_ICON get their icon from the older sources, which
+   need the GUI thread's X connection. Those are server side pixmaps already,
+   so they are read back once here and kept as images like all the others. */
+void LeafbarWindowModel::storeIcon(LeafbarWindowInfo *i, int width, int height,
+                                   const TQImage &img)
+{
+    TQImage icon = img;
+    if (icon.isNull())
+    {
+        icon = KWin::icon(i->m_window, width, height, true,
+                          KWin::WMHints | KWin::ClassHint | KWin::XApp).convertToImage();
+    }
+    i->m_icons.insert(TQString("%1x%2").arg(width).arg(height), icon);
+}
+
+void LeafbarWindowModel::customEvent(TQCustomEvent *ce)
+{
+    if (ce->type() != LeafbarIconEvent::Type) return;
+
+    LeafbarIconEvent *e = static_cast<LeafbarIconEvent *>(ce);
+    m_iconBytes += e->bytes();
+
+    // Drop icons of windows which are gone or have changed their icon since
+    LeafbarWindowInfo *i = m_windows[e->window()];
+    if (!i || i->m_iconRevision != e->revision()) return;
+
+    i->m_iconRequests.remove(TQString("%1x%2").arg(e->width()).arg(e->height()));
+    storeIcon(i, e->width(), e->height(), e->image());
+    emit iconReady(e->window());
+}
+
+/* Yes, I know _NET_WM_PID is not reliable and the actual application might be
+   on another host, but this is the best way to get the application's
+   executable and figure out its corresponding desktop file. Only done again
+   when the pid changes. */
+void LeafbarWindowModel::resolveProcess(LeafbarWindowInfo *i)
+{
+    i->m_exePath = TQString::null;
+    i->m_cmdline = TQString::null;
+    if (i->m_pid <= 0) return;
+
+    TQFileInfo exe(TQString("/proc/%1/exe").arg(i->m_pid));
+    if (exe.exists() && exe.isSymLink())
+    {
+        i->m_exePath = exe.readLink();
+    }
+
+    TQFile cmdline(TQString("/proc/%1/cmdline").arg(i->m_pid));
+    if (cmdline.exists() && cmdline.open(IO_ReadOnly))
+    {
+        i->m_cmdline = TQString::fromLocal8Bit(cmdline.readAll());
+    }
+}
+
+void LeafbarWindowModel::slotWindowAdded(WId w)
+{
+    if (!m_windows[w])
+    {
+        m_windows.insert(w, new LeafbarWindowInfo(w));
+    }
+    emit windowAdded(w);
+}
+
+void LeafbarWindowModel::slotWindowRemoved(WId w)
+{
+    if (!m_windows[w]) return;
+
+    emit windowRemoved(w);
+    m_windows.remove(w);
+}
+
+void LeafbarWindowModel::slotWindowChanged(WId w, unsigned int properties,
+                                           unsigned int properties2)
+{
+    LeafbarWindowInfo *i = m_windows[w];
+    if (!i) return;
+
+    if (properties & NET::WMIcon)
+    {
+        ++i->m_iconRevision;
+        i->m_icons.clear();
+        i->m_iconRequests.clear();
+    }
+
+    // Read back lazily, see info()
+    i->m_stale |= properties & WINDOW_MODEL_PROPERTIES;
+    i->m_stale2 |= properties2 & WINDOW_MODEL_PROPERTIES2;
+
+    emit windowChanged(w, properties, properties2);
+}
+
+/* kate: replace-tabs true; tab-width 4; */
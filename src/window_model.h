@@ -0,0 +1,145 @@
+/*******************************************************************************
+  Leafbar - a DeskBar-style panel for TDE
+  Copyright (C) 2023-2025 Philippe Mavridis <philippe.mavridis@yandex.com>
+
+  This program is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free Software
+  Foundation, either version 3 of the License, or (at your option) any later
+  version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License along with
+  this program. If not, see <http://www.gnu.org/licenses/>.
+
+  Improvements and feedback are welcome!
+*******************************************************************************/
+
+#ifndef _LEAFBAR_WINDOW_MODEL_H
+#define _LEAFBAR_WINDOW_MODEL_H
+
+// TQt
+#include <tqobject.h>
+#include <tqintdict.h>
+#include <tqvaluelist.h>
+#include <tqmap.h>
+#include <tqimage.h>
+#include <tqrect.h>
+
+// TDE
+#include <twin.h>
+
+class KWinModule;
+class LeafbarIconFetcher;
+struct LeafbarWindowRequests;
+
+// Window properties kept by LeafbarWindowModel
+#define WINDOW_MODEL_PROPERTIES (NET::WMWindowType | NET::WMState | NET::XAWMState | \
+                                 NET::WMName | NET::WMVisibleName | NET::WMDesktop | \
+                                 NET::WMGeometry | NET::WMPid)
+#define WINDOW_MODEL_PROPERTIES2 (NET::WM2WindowClass)
+
+/* The state of one client window as last read from the X server. Obtain it
+   through LeafbarWindowModel::info(), which brings it up to date first. */
+class LeafbarWindowInfo {
+  public:
+    WId window() const { return m_window; }
+    bool valid() const { return m_valid; }
+
+    NET::WindowType windowType() const { return m_type; }
+    unsigned long state() const { return m_state; }
+    bool isMinimized() const { return m_minimized; }
+    int desktop() const { return m_desktop; } // 0 for all desktops
+    TQString visibleNameWithState() const { return m_visibleName; }
+    TQRect geometry() const { return m_geometry; }
+    TQString resourceName() const { return m_resName; }
+    TQString resourceClass() const { return m_resClass; }
+    int pid() const { return m_pid; }
+    TQString executablePath() const { return m_exePath; }
+    TQString cmdline() const { return m_cmdline; }
+    uint iconRevision() const { return m_iconRevision; }
+
+  private:
+    LeafbarWindowInfo(WId w);
+
+    WId m_window;
+    bool m_valid;
+    NET::WindowType m_type;
+    unsigned long m_state;
+    bool m_minimized;
+    int m_desktop;
+    TQString m_visibleName;
+    TQRect m_geometry;
+    TQString m_resName, m_resClass;
+    int m_pid;
+    TQString m_exePath, m_cmdline;
+    uint m_iconRevision;
+
+    // Properties changed since they were last read
+    unsigned long m_stale, m_stale2;
+
+    // Icons by size for the current icon revision, see LeafbarWindowModel::icon()
+    TQMap<TQString, TQImage> m_icons;
+    TQMap<TQString, bool> m_iconRequests;
+
+  friend class LeafbarWindowModel;
+};
+
+/* Window state shared by all applets, kept up to date incrementally.
+   Properties are read from the X server at most once per change, when the
+   first applet asks for them, however many applets are interested. All the
+   properties of a window are read in a single round trip, and prefetch()
+   does the same for any number of windows.
+
+   Desktop-wide state (current desktop, desktop names...) is available
+   through twin(), which applets should use instead of their own KWinModule. */
+class LeafbarWindowModel : public TQObject {
+  TQ_OBJECT
+
+  public:
+    LeafbarWindowModel(TQObject *parent = nullptr);
+    ~LeafbarWindowModel();
+
+    KWinModule *twin() const { return m_twin; }
+
+    const LeafbarWindowInfo *info(WId w);
+    void prefetch(const TQValueList<WId> &windows);
+    TQImage icon(WId w, int width, int height);
+
+    uint count() const { return m_windows.count(); }
+    uint fetches() const { return m_fetches; }
+    ulong iconBytes() const { return m_iconBytes; }
+
+  signals:
+    void windowAdded(WId w);
+    void windowRemoved(WId w);
+    // NET::Property and NET::Property2 masks of what changed
+    void windowChanged(WId w, unsigned int properties, unsigned int properties2);
+    void iconReady(WId w);
+
+  protected:
+    void customEvent(TQCustomEvent *e);
+
+  private slots:
+    void slotWindowAdded(WId w);
+    void slotWindowRemoved(WId w);
+    void slotWindowChanged(WId w, unsigned int properties, unsigned int properties2);
+
+  private:
+    KWinModule *m_twin;
+    TQIntDict<LeafbarWindowInfo> m_windows;
+    uint m_fetches;
+    ulong m_iconBytes;
+    LeafbarIconFetcher *m_fetcher;
+
+    void fetch(const TQValueList<LeafbarWindowInfo *> &infos);
+    void sendRequests(LeafbarWindowRequests &r);
+    void readReplies(LeafbarWindowRequests &r);
+    void storeIcon(LeafbarWindowInfo *i, int width, int height, const TQImage &img);
+    void resolveProcess(LeafbarWindowInfo *i);
+};
+
+#endif // _LEAFBAR_WINDOW_MODEL_H
+
+/* kate: replace-tabs true; tab-width 2; */